@@ -0,0 +1,115 @@
+// Compares the ctp kernels, whose coefficients are template parameters, to the
+// equivalent loops over coefficients that are only known at runtime. Build with
+// optimizations (and e.g. -march=native), then run:
+//
+//      ./kernels [iterations]
+#include <ctp/ctp.hh>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr auto poly_coeffs = std::to_array({1.0, 0.0, -0.5, 0.0, 1.0 / 24, 0.0, -1.0 / 720});
+constexpr auto fir_taps = std::to_array({0.25, 0.0, 0.5, 0.0, 0.25, 0.0, 0.0, -1.0});
+constexpr double mat[4][4] = {
+    {1, 0, 0, 0},
+    {0, 2, 0, 0},
+    {0, 0, 1, -1},
+    {0.5, 0, 0, 1},
+};
+
+using poly = ctp::polynomial<std::vector(poly_coeffs.begin(), poly_coeffs.end())>;
+using filter = ctp::fir<std::vector(fir_taps.begin(), fir_taps.end())>;
+using transform = ctp::matvec<std::vector<std::vector<double>>{
+    {mat[0][0], mat[0][1], mat[0][2], mat[0][3]},
+    {mat[1][0], mat[1][1], mat[1][2], mat[1][3]},
+    {mat[2][0], mat[2][1], mat[2][2], mat[2][3]},
+    {mat[3][0], mat[3][1], mat[3][2], mat[3][3]},
+}>;
+
+// The runtime versions read their coefficients through a volatile pointer so
+// that the optimizer cannot treat them as constants either
+[[gnu::noinline]] auto runtime_polynomial(std::span<double const> cs, std::span<double const> in, std::span<double> out) -> void {
+    for (std::size_t i = 0; i != in.size(); ++i) {
+        double r = 0;
+        for (std::size_t k = cs.size(); k-- != 0; ) {
+            r = r * in[i] + cs[k];
+        }
+        out[i] = r;
+    }
+}
+
+[[gnu::noinline]] auto runtime_fir(std::span<double const> taps, std::span<double const> in, std::span<double> out) -> void {
+    std::size_t const n = in.size() - taps.size() + 1;
+    for (std::size_t i = 0; i != n; ++i) {
+        double acc = 0;
+        for (std::size_t k = 0; k != taps.size(); ++k) {
+            acc += taps[k] * in[i + taps.size() - 1 - k];
+        }
+        out[i] = acc;
+    }
+}
+
+[[gnu::noinline]] auto runtime_matvec(double const (*m)[4], std::span<double const> in, std::span<double> out) -> void {
+    for (std::size_t v = 0; v != in.size() / 4; ++v) {
+        for (std::size_t r = 0; r != 4; ++r) {
+            double acc = 0;
+            for (std::size_t c = 0; c != 4; ++c) {
+                acc += m[r][c] * in[v * 4 + c];
+            }
+            out[v * 4 + r] = acc;
+        }
+    }
+}
+
+template <class F>
+auto measure(char const* name, int iterations, std::size_t elements, std::span<double const> out, F f) -> void {
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != iterations; ++i) {
+        f();
+    }
+    std::chrono::duration<double, std::nano> const elapsed = std::chrono::steady_clock::now() - start;
+
+    double checksum = 0;
+    for (double d : out) {
+        checksum += d;
+    }
+    std::printf("%-20s %8.3f ns/element  (checksum %g)\n",
+                name, elapsed.count() / (double(iterations) * elements), checksum);
+}
+
+template <class T>
+auto opaque(T const* p) -> T const* {
+    T const* volatile q = p;
+    return q;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int const iterations = argc > 1 ? std::atoi(argv[1]) : 1000;
+    std::size_t const n = 1 << 16;
+
+    std::vector<double> in(n);
+    for (std::size_t i = 0; i != n; ++i) {
+        in[i] = double(i % 1000) / 1000;
+    }
+    std::vector<double> out(n);
+
+    measure("polynomial (ctp)", iterations, n, out, [&]{ poly::apply<double>(in, out); });
+    measure("polynomial (loop)", iterations, n, out, [&]{
+        runtime_polynomial({opaque(poly_coeffs.data()), poly_coeffs.size()}, in, out);
+    });
+
+    std::size_t const windows = n - fir_taps.size() + 1;
+    measure("fir (ctp)", iterations, windows, out, [&]{ filter::apply<double>(in, out); });
+    measure("fir (loop)", iterations, windows, out, [&]{
+        runtime_fir({opaque(fir_taps.data()), fir_taps.size()}, in, out);
+    });
+
+    measure("matvec (ctp)", iterations, n, out, [&]{ transform::apply<double>(in, out); });
+    measure("matvec (loop)", iterations, n, out, [&]{ runtime_matvec(opaque(mat), in, out); });
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+// A compile-time benchmark: one translation unit with PARAMS distinct
+// ctp::Params of a variant with ALTERNATIVES alternatives. By default every
+// value uses one of the first eight alternatives, so that std::in_place_index
+// and std::get (which may themselves take time linear in the index) cost the
+// same whatever ALTERNATIVES is, which isolates what ctp does per value. With
+// SPREAD defined, there is instead one param per alternative, so the values
+// use every alternative, as a message type with many alternatives would. See
+// variant_scaling.
+#include <ctp/ctp.hh>
+
+#include <utility>
+
+#ifndef ALTERNATIVES
+#define ALTERNATIVES 100
+#endif
+
+#ifdef SPREAD
+#undef PARAMS
+#define PARAMS ALTERNATIVES
+#define INDEX(I) (I)
+#else
+#define INDEX(I) ((I) % 8)
+#endif
+
+#ifndef PARAMS
+#define PARAMS 100
+#endif
+
+static_assert(ALTERNATIVES >= 8);
+
+template <size_t I>
+struct alternative {
+    int value;
+};
+
+template <size_t... Is>
+auto make_message(std::index_sequence<Is...>) -> std::variant<alternative<Is>...>;
+
+using message = decltype(make_message(std::make_index_sequence<ALTERNATIVES>()));
+
+template <ctp::Param<message> M>
+struct handler {
+    static constexpr auto& value = M.value;
+};
+
+template <size_t... Is>
+consteval auto sum_all(std::index_sequence<Is...>) -> long {
+    return (0l + ... + std::get<INDEX(Is)>(handler<message(std::in_place_index<INDEX(Is)>, int(Is))>::value).value);
+}
+
+static_assert(sum_all(std::make_index_sequence<PARAMS>()) == long(PARAMS) * (PARAMS - 1) / 2);
+
+int main() { }
@@ -51,11 +51,31 @@ template <class T>
 using target_or_ref = [: is_lvalue_reference_type(^^T) ? ^^T : substitute(^^target, {^^T}) :];
 
 
+// Opt-in: with CTP_SHARED_IDENTITY defined (consistently, in every TU of every
+// module), the objects that ctp creates get default visibility even under
+// -fvisibility=hidden. Being inline variables, they are then merged by the
+// dynamic linker, so that a given value has one address across the executable
+// and any dlopen()-ed plugins, and can be compared by address alone. This
+// requires that the first module to define an object is visible to the others:
+// link the executable with -rdynamic (or load plugins with RTLD_GLOBAL), and do
+// not link plugins with -Bsymbolic. See dlopen_test/ for a checked example.
+//
+// This covers every object returned by ctp::define_static_object (and so the
+// value of a ctp::Param of a non-structural type), but not template parameter
+// objects that ctp does not create: the value of a ctp::Param of a structural
+// type lives in the Param itself, and has the visibility the compiler gives it.
+// Use ctp::define_static_object(*V) where such an object needs one address.
+#ifdef CTP_SHARED_IDENTITY
+#define CTP_OBJECT_VISIBILITY [[gnu::visibility("default")]]
+#else
+#define CTP_OBJECT_VISIBILITY
+#endif
+
 namespace impl {
     // This is the singular (private) object that will be
     // constructed from the serialization-deserialization round trip.
     template <class T, std::meta::info... Is>
-    inline constexpr target<T> the_object = []{
+    CTP_OBJECT_VISIBILITY inline constexpr target<T> the_object = []{
         if constexpr (requires { Reflect<T>::template deserialize<Is...>(); }) {
             return Reflect<T>::template deserialize<Is...>();
         } else if constexpr (requires { Reflect<T>::deserialize(Is...); }) {
@@ -65,9 +85,15 @@ namespace impl {
         }
     }();
 
+    // With CTP_SHARED_IDENTITY, the object that ctp::define_static_object returns
+    // for a structural type, in place of a template parameter object (whose
+    // visibility ctp cannot control)
+    template <class T, T V>
+    CTP_OBJECT_VISIBILITY inline constexpr T the_value = V;
+
     // This is the singular (private) object that will be used for reflect_constant_array
     template <class T, std::meta::info... Is>
-    inline constexpr target<T> the_array[] = {[:Is:]...};
+    CTP_OBJECT_VISIBILITY inline constexpr target<T> the_array[] = {[:Is:]...};
 
     // The default/simple approach to serialization, using Serializer
     template <class T>
@@ -114,6 +140,11 @@ inline constexpr auto reflect_constant_array =
 // Extension of std::define_static_object, except based on ctp::reflect_constant
 inline constexpr auto define_static_object =
     []<class T>(T const& v) -> target<T> const& {
+        #ifdef CTP_SHARED_IDENTITY
+        if constexpr (is_structural_type(^^T)) {
+            return extract<T const&>(substitute(^^impl::the_value, {^^T, reflect_constant(v)}));
+        } else
+        #endif
         // ctp::reflect_constant gives us a reflection representing an object
         // UNLESS T is a scalar type, in which case we have to do something else
         if constexpr (is_class_type(^^T)) {
@@ -236,6 +267,393 @@ Param(T) -> Param<T>;
 #ifndef CTP_CUSTOM_HH
 #define CTP_CUSTOM_HH
 
+#ifndef CTP_BITMASK_HH
+#define CTP_BITMASK_HH
+
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ctp {
+
+// A fixed-width set of bits, with all of its state in public members so that it
+// is a structural type. This is the target of std::bitset<N>, and the storage of
+// ctp::enum_set. Equal masks compare equal as template arguments no matter how
+// they were built.
+template <std::size_t N>
+struct bitmask {
+    static constexpr std::size_t word_bits = 64;
+    // always at least one word, since std::array<T, 0> need not be structural
+    static constexpr std::size_t word_count = N == 0 ? 1 : (N + word_bits - 1) / word_bits;
+
+    std::array<std::uint64_t, word_count> words = {};
+
+    static constexpr auto size() -> std::size_t { return N; }
+
+    constexpr auto test(std::size_t i) const -> bool {
+        return (words[i / word_bits] >> (i % word_bits)) & 1;
+    }
+    constexpr auto set(std::size_t i, bool value = true) -> bitmask& {
+        std::uint64_t const bit = std::uint64_t(1) << (i % word_bits);
+        words[i / word_bits] = (words[i / word_bits] & ~bit) | (value ? bit : 0);
+        return *this;
+    }
+    constexpr auto reset(std::size_t i) -> bitmask& { return set(i, false); }
+
+    constexpr auto count() const -> std::size_t {
+        std::size_t n = 0;
+        for (std::uint64_t w : words) {
+            n += std::popcount(w);
+        }
+        return n;
+    }
+    constexpr auto any() const -> bool { return *this != bitmask(); }
+    constexpr auto none() const -> bool { return not any(); }
+    constexpr auto all() const -> bool { return count() == N; }
+
+    // Every bit of *this is also set in other
+    constexpr auto is_subset_of(bitmask const& other) const -> bool {
+        return (*this & other) == *this;
+    }
+
+    constexpr auto operator&=(bitmask const& rhs) -> bitmask& {
+        for (std::size_t i = 0; i != word_count; ++i) {
+            words[i] &= rhs.words[i];
+        }
+        return *this;
+    }
+    constexpr auto operator|=(bitmask const& rhs) -> bitmask& {
+        for (std::size_t i = 0; i != word_count; ++i) {
+            words[i] |= rhs.words[i];
+        }
+        return *this;
+    }
+    constexpr auto operator^=(bitmask const& rhs) -> bitmask& {
+        for (std::size_t i = 0; i != word_count; ++i) {
+            words[i] ^= rhs.words[i];
+        }
+        return *this;
+    }
+
+    friend constexpr auto operator&(bitmask lhs, bitmask const& rhs) -> bitmask { return lhs &= rhs; }
+    friend constexpr auto operator|(bitmask lhs, bitmask const& rhs) -> bitmask { return lhs |= rhs; }
+    friend constexpr auto operator^(bitmask lhs, bitmask const& rhs) -> bitmask { return lhs ^= rhs; }
+
+    // Complement, keeping the bits past N clear so that equality stays meaningful
+    constexpr auto operator~() const -> bitmask {
+        bitmask r;
+        for (std::size_t i = 0; i != word_count; ++i) {
+            r.words[i] = ~words[i];
+        }
+        if constexpr (N % word_bits != 0) {
+            r.words[word_count - 1] &= (std::uint64_t(1) << (N % word_bits)) - 1;
+        } else if constexpr (N == 0) {
+            r.words[0] = 0;
+        }
+        return r;
+    }
+
+    constexpr auto operator==(bitmask const&) const -> bool = default;
+};
+
+namespace impl {
+    // A perfect hash from a fixed set of 64-bit keys to slots, found at compile
+    // time by hash-and-displace: a key's bucket is the high bits of its mixed
+    // hash, and its slot is the low bits xor-ed with a displacement chosen per
+    // bucket so that no two keys share a slot. Each slot records the key that
+    // owns it (if any) and that key's rank, so a lookup is one hash and three
+    // table reads, with no loops.
+    struct perfect_hash {
+        // false if no seed worked, in which case nothing else is meaningful
+        bool found;
+        std::uint64_t seed;
+        int bucket_bits;
+        std::uint64_t slot_mask;
+        std::span<std::uint64_t const> displacements;
+        std::span<std::uint64_t const> slot_keys;
+        std::span<std::uint32_t const> slot_ranks;
+    };
+
+    constexpr auto perfect_hash_mix(std::uint64_t key, std::uint64_t seed) -> std::uint64_t {
+        std::uint64_t h = key ^ seed;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return h;
+    }
+
+    constexpr auto perfect_hash_bucket(perfect_hash const& ph, std::uint64_t h) -> std::size_t {
+        return ph.bucket_bits == 0 ? 0 : std::size_t(h >> (64 - ph.bucket_bits));
+    }
+
+    constexpr auto perfect_hash_slot(perfect_hash const& ph, std::uint64_t key) -> std::size_t {
+        std::uint64_t const h = perfect_hash_mix(key, ph.seed);
+        return std::size_t((h ^ ph.displacements[perfect_hash_bucket(ph, h)]) & ph.slot_mask);
+    }
+
+    // The rank of key in the keys the hash was built from, or missing if it is
+    // not one of them
+    constexpr auto perfect_hash_find(perfect_hash const& ph, std::uint64_t key, std::size_t missing) -> std::size_t {
+        std::size_t const slot = perfect_hash_slot(ph, key);
+        return ph.slot_keys[slot] == key ? ph.slot_ranks[slot] : missing;
+    }
+
+    // keys must be distinct; key i gets rank i
+    consteval auto make_perfect_hash(std::span<std::uint64_t const> keys) -> perfect_hash {
+        std::size_t const n = keys.size();
+        std::size_t const slots = std::bit_ceil(2 * n);
+        int const bucket_bits = std::bit_width(std::bit_ceil(std::max<std::size_t>(n / 4, 1))) - 1;
+        std::size_t const buckets = std::size_t(1) << bucket_bits;
+
+        perfect_hash ph = {.found = false, .bucket_bits = bucket_bits, .slot_mask = slots - 1};
+        std::uint64_t rng = 0x2545f4914f6cdd1d;
+        for (int attempt = 0; attempt != 256; ++attempt) {
+            // splitmix64
+            rng += 0x9e3779b97f4a7c15;
+            ph.seed = perfect_hash_mix(rng, 0);
+
+            std::vector<std::vector<std::size_t>> by_bucket(buckets);
+            for (std::size_t i = 0; i != n; ++i) {
+                by_bucket[perfect_hash_bucket(ph, perfect_hash_mix(keys[i], ph.seed))].push_back(i);
+            }
+            std::vector<std::size_t> order(buckets);
+            for (std::size_t b = 0; b != buckets; ++b) {
+                order[b] = b;
+            }
+            // the biggest buckets are the hardest to place, so they go first
+            std::ranges::stable_sort(order, std::ranges::greater(),
+                                     [&](std::size_t b) { return by_bucket[b].size(); });
+
+            std::vector<std::uint64_t> displacements(buckets, 0);
+            std::vector<std::uint64_t> slot_keys(slots, 0);
+            // an empty slot has rank n, which is a miss whatever key it has
+            std::vector<std::uint32_t> slot_ranks(slots, std::uint32_t(n));
+            std::vector<bool> used(slots, false);
+            bool placed_all = true;
+            for (std::size_t b : order) {
+                bool placed = by_bucket[b].empty();
+                for (std::uint64_t d = 0; d != slots and not placed; ++d) {
+                    std::vector<std::size_t> taken;
+                    for (std::size_t i : by_bucket[b]) {
+                        std::size_t const slot = (perfect_hash_mix(keys[i], ph.seed) ^ d) & ph.slot_mask;
+                        if (used[slot] or std::ranges::contains(taken, slot)) {
+                            break;
+                        }
+                        taken.push_back(slot);
+                    }
+                    if (taken.size() != by_bucket[b].size()) {
+                        continue;
+                    }
+                    displacements[b] = d;
+                    for (std::size_t j = 0; j != taken.size(); ++j) {
+                        used[taken[j]] = true;
+                        slot_keys[taken[j]] = keys[by_bucket[b][j]];
+                        slot_ranks[taken[j]] = std::uint32_t(by_bucket[b][j]);
+                    }
+                    placed = true;
+                }
+                if (not placed) {
+                    placed_all = false;
+                    break;
+                }
+            }
+            if (not placed_all) {
+                continue;
+            }
+
+            ph.displacements = std::define_static_array(displacements);
+            ph.slot_keys = std::define_static_array(slot_keys);
+            ph.slot_ranks = std::define_static_array(slot_ranks);
+            ph.found = true;
+            return ph;
+        }
+        return {};
+    }
+
+    // The unsigned type in which distances between values of E are computed.
+    // bool has no make_unsigned_t, but is already unsigned.
+    template <class E>
+    using enum_unsigned_t = [: std::same_as<std::underlying_type_t<E>, bool>
+                               ? ^^unsigned char
+                               : substitute(^^std::make_unsigned_t, {^^std::underlying_type_t<E>}) :];
+
+    // The distance from lo up to e, which fits in the unsigned type even when
+    // e - lo does not fit in the underlying one. The result is converted back
+    // to the unsigned type, since a narrower one is promoted to int by the
+    // subtraction.
+    template <class E>
+    constexpr auto enum_offset(E e, E lo) -> std::size_t {
+        using K = enum_unsigned_t<E>;
+        return std::size_t(K(K(e) - K(lo)));
+    }
+
+    // The domain of an enum_set: the distinct enumerator values of E, sorted.
+    // When they span a small enough range, the bit for a value is just its
+    // distance from the smallest one (and the bits for values in between that
+    // are not enumerators are never set); otherwise it is its rank in values,
+    // found through a perfect hash.
+    template <class E>
+    struct enum_domain {
+        std::span<E const> values;
+        E min;
+        bool dense;
+        std::size_t width;
+        perfect_hash hash;
+    };
+
+    inline constexpr std::size_t max_dense_enum_width = 1024;
+
+    template <class E>
+    consteval auto make_enum_domain() -> enum_domain<E> {
+        using U = std::underlying_type_t<E>;
+        std::vector<E> values;
+        for (std::meta::info e : enumerators_of(^^E)) {
+            values.push_back(extract<E>(e));
+        }
+        std::ranges::sort(values, {}, [](E e) { return U(e); });
+        values.erase(std::ranges::unique(values).begin(), values.end());
+
+        if (values.empty()) {
+            return {.values = {}, .min = E(), .dense = true, .width = 0, .hash = {}};
+        }
+        E const lo = values.front();
+        std::size_t const range = enum_offset(values.back(), lo);
+        if (range < max_dense_enum_width) {
+            return {
+                .values = std::define_static_array(values),
+                .min = lo,
+                .dense = true,
+                .width = range + 1,
+                .hash = {},
+            };
+        }
+
+        std::vector<std::uint64_t> keys;
+        for (E e : values) {
+            keys.push_back(std::uint64_t(U(e)));
+        }
+        return {
+            .values = std::define_static_array(values),
+            .min = lo,
+            .dense = false,
+            .width = values.size(),
+            .hash = make_perfect_hash(keys),
+        };
+    }
+}
+
+namespace impl {
+    template <class E, std::size_t Width>
+    consteval auto enum_valid_bits(enum_domain<E> const& domain) -> bitmask<Width> {
+        bitmask<Width> m;
+        for (std::size_t i = 0; i != domain.values.size(); ++i) {
+            m.set(domain.dense ? enum_offset(domain.values[i], domain.min) : i);
+        }
+        return m;
+    }
+}
+
+// A set of enumerators of E, stored as a bitmask, which makes this a structural
+// type (and the target of std::set<E>). When the enumerators span at most 1024
+// values, there is a bit for every value in that range, and the bit for a value
+// is found with a subtraction; otherwise there is one bit per enumerator, found
+// through a perfect hash. Either way, contains() is constant time, without
+// loops, and rejects anything that is not an enumerator of E.
+template <class E>
+    requires std::is_enum_v<E>
+struct enum_set {
+    static constexpr impl::enum_domain<E> domain = impl::make_enum_domain<E>();
+    static_assert(domain.dense or domain.hash.found,
+                  "could not find a perfect hash for the enumerators of E");
+    using mask_type = bitmask<domain.width>;
+
+    mask_type bits = {};
+
+    constexpr enum_set() = default;
+    constexpr enum_set(std::initializer_list<E> es) {
+        for (E e : es) {
+            insert(e);
+        }
+    }
+
+    // The number of possible members, which is the width of the mask
+    static constexpr auto capacity() -> std::size_t { return domain.width; }
+
+    // The bits that belong to enumerators, which in the dense case are not
+    // necessarily all of them
+    static constexpr mask_type valid = impl::enum_valid_bits<E, domain.width>(domain);
+
+    // The bit position for e, or capacity() if e is not an enumerator of E
+    static constexpr auto index_of(E e) -> std::size_t {
+        using U = std::underlying_type_t<E>;
+        if constexpr (domain.dense) {
+            std::size_t const i = impl::enum_offset(e, domain.min);
+            return i < domain.width and valid.test(i) ? i : domain.width;
+        } else {
+            return impl::perfect_hash_find(domain.hash, std::uint64_t(U(e)), domain.width);
+        }
+    }
+
+    constexpr auto contains(E e) const -> bool {
+        std::size_t const i = index_of(e);
+        return i != domain.width && bits.test(i);
+    }
+    constexpr auto insert(E e) -> enum_set& {
+        if (std::size_t const i = index_of(e); i != domain.width) {
+            bits.set(i);
+        }
+        return *this;
+    }
+    constexpr auto erase(E e) -> enum_set& {
+        if (std::size_t const i = index_of(e); i != domain.width) {
+            bits.reset(i);
+        }
+        return *this;
+    }
+
+    constexpr auto size() const -> std::size_t { return bits.count(); }
+    constexpr auto empty() const -> bool { return bits.none(); }
+    constexpr auto is_subset_of(enum_set const& other) const -> bool {
+        return bits.is_subset_of(other.bits);
+    }
+
+    friend constexpr auto operator&(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits &= rhs.bits;
+        return lhs;
+    }
+    friend constexpr auto operator|(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits |= rhs.bits;
+        return lhs;
+    }
+    friend constexpr auto operator^(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits ^= rhs.bits;
+        return lhs;
+    }
+    // Set difference
+    friend constexpr auto operator-(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits &= ~rhs.bits;
+        return lhs;
+    }
+
+    constexpr auto operator==(enum_set const&) const -> bool = default;
+};
+
+}
+
+#endif
+
+#include <bitset>
+#include <set>
 
 namespace ctp {
     template <>
@@ -264,6 +682,59 @@ namespace ctp {
         }
     };
 
+    // A set is serialized like a vector of its (already sorted, unique) elements
+    template <class T>
+    struct Reflect<std::set<T>> {
+        using target_type = std::span<target<T> const>;
+
+        static consteval auto serialize(Serializer& s, std::set<T> const& v) -> void {
+            s.push(reflect_constant_array(v));
+        }
+
+        static consteval auto deserialize(std::meta::info r) -> std::span<target<T> const> {
+            return std::span(extract<target<T> const*>(r), extent(type_of(r)));
+        }
+    };
+
+    // ... except for a set of enumerators, which becomes a bitmask over the
+    // enumerators of E
+    template <class E> requires std::is_enum_v<E>
+    struct Reflect<std::set<E>> {
+        using target_type = enum_set<E>;
+
+        static consteval auto serialize(Serializer& s, std::set<E> const& v) -> void {
+            enum_set<E> m;
+            for (E e : v) {
+                if (enum_set<E>::index_of(e) == enum_set<E>::capacity()) {
+                    throw "ctp::enum_set can only hold enumerators of E";
+                }
+                m.insert(e);
+            }
+            s.push_constant(m);
+        }
+
+        static consteval auto deserialize_constants(enum_set<E> const& m) -> target_type {
+            return m;
+        }
+    };
+
+    template <size_t N>
+    struct Reflect<std::bitset<N>> {
+        using target_type = bitmask<N>;
+
+        static consteval auto serialize(Serializer& s, std::bitset<N> const& b) -> void {
+            bitmask<N> m;
+            for (size_t i = 0; i != N; ++i) {
+                m.set(i, b.test(i));
+            }
+            s.push_constant(m);
+        }
+
+        static consteval auto deserialize_constants(bitmask<N> const& m) -> target_type {
+            return m;
+        }
+    };
+
     template <class T>
     struct Reflect<std::optional<T>> {
         using target_type = std::optional<target<T>>;
@@ -296,17 +767,24 @@ namespace ctp {
 
     template <class... Ts>
     struct Reflect<std::variant<Ts...>> {
+        // this still needs target<Ts> for every alternative, but only once per
+        // variant type, not once per value
         using target_type = std::variant<target<Ts>...>;
 
+        template <size_t I>
+        static consteval auto serialize_alternative(Serializer& s, std::variant<Ts...> const& v) -> void {
+            s.push_constant(*std::get_if<I>(&v));
+        }
+
         static consteval auto serialize(Serializer& s, std::variant<Ts...> const& v) -> void {
             s.push_constant(v.index());
-            // visit should work, but can't because of LWG4197
-            template for (constexpr size_t I : std::views::iota(0zu, sizeof...(Ts))) {
-                if (I == v.index()) {
-                    s.push_constant(std::get<I>(v));
-                    return;
-                }
-            }
+            // Rather than scanning the alternatives for the active one (visit
+            // can't be used because of LWG4197), which costs linear time per
+            // value and instantiates push_constant for every alternative, splice
+            // in the serializer for just the active one
+            auto serialize_active = extract<void (*)(Serializer&, std::variant<Ts...> const&)>(
+                substitute(^^serialize_alternative, {std::meta::reflect_constant(v.index())}));
+            serialize_active(s, v);
         }
 
         template <std::meta::info I, std::meta::info R>
@@ -357,6 +835,1740 @@ namespace ctp {
     };
 }
 
+#endif
+#ifndef CTP_EXTERN_HH
+#define CTP_EXTERN_HH
+
+
+// Building a large ctp object (serializing it, and then instantiating its
+// ctp::impl::the_object) happens in every translation unit that names it.
+// For objects that are only needed at runtime, these macros move all of that
+// work into one translation unit:
+//
+//      // tables.hh: every other TU only sees a declaration
+//      CTP_EXTERN_PARAM(std::vector<int>, primes);
+//
+//      // tables.cc: the one TU that evaluates and emits the object
+//      CTP_INSTANTIATE_PARAM(std::vector<int>, primes, compute_primes(100'000));
+//
+// Both declare a reference to target<T> named name, in the current namespace.
+// Outside of the instantiating TU it cannot be used in constant expressions,
+// since its value is not known there. It is constant-initialized, so there is
+// no static initialization order to worry about. The object is the same one that
+// ctp::define_static_object would return for the same value, so it keeps its
+// identity with any other use of that value. T cannot contain an unparenthesized
+// comma; use an alias for such types.
+#define CTP_EXTERN_PARAM(T, name) \
+    extern constinit ::ctp::target<T> const& name
+
+#define CTP_INSTANTIATE_PARAM(T, name, ...) \
+    constinit ::ctp::target<T> const& name = ::ctp::define_static_object(T(__VA_ARGS__))
+
+#endif
+#ifndef CTP_COMPRESSED_HH
+#define CTP_COMPRESSED_HH
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace ctp {
+
+// How hard ctp::compressed should work at compile time. Every level other than
+// none produces the same format, so decoding speed only depends on the amount
+// of data: higher levels follow longer match chains and give smaller images in
+// exchange for more constant evaluation. none stores the bytes as-is, for when
+// access latency matters more than binary size.
+enum class compression {
+    none,
+    fast,
+    balanced,
+    best,
+};
+
+namespace impl {
+    // The result of compressing at compile time. Block i of the original data
+    // is stored in bytes[offsets[i]:offsets[i+1]], and every block is encoded
+    // independently so that it can be decompressed on its own.
+    struct compressed_image {
+        std::span<std::byte const> bytes;
+        std::span<std::size_t const> offsets;
+        std::size_t size;
+    };
+
+    // A small LZ77 codec, in the style of LZ4. Each sequence is a token byte
+    // (high nibble: literal count, low nibble: match length - 4, 15 meaning
+    // that more length bytes follow), the literals, and then a two byte
+    // little-endian distance followed by any extra match length bytes. The
+    // last sequence of a block has only literals.
+    namespace lz {
+        inline constexpr std::size_t min_match = 4;
+        inline constexpr std::size_t max_distance = 65535;
+        inline constexpr int hash_bits = 14;
+
+        consteval auto chain_depth(compression level) -> int {
+            switch (level) {
+            case compression::none:     return 0;
+            case compression::fast:     return 1;
+            case compression::balanced: return 16;
+            case compression::best:     return 256;
+            }
+            return 0;
+        }
+
+        consteval auto hash(std::span<std::byte const> in, std::size_t i) -> std::size_t {
+            std::uint32_t v = std::to_integer<std::uint32_t>(in[i])
+                | std::to_integer<std::uint32_t>(in[i + 1]) << 8
+                | std::to_integer<std::uint32_t>(in[i + 2]) << 16
+                | std::to_integer<std::uint32_t>(in[i + 3]) << 24;
+            return (v * 2654435761u) >> (32 - hash_bits);
+        }
+
+        consteval auto push_length(std::vector<std::byte>& out, std::size_t n) -> void {
+            while (n >= 255) {
+                out.push_back(std::byte(255));
+                n -= 255;
+            }
+            out.push_back(std::byte(n));
+        }
+
+        consteval auto push_sequence(std::vector<std::byte>& out,
+                                     std::span<std::byte const> literals,
+                                     std::size_t distance,
+                                     std::size_t length) -> void {
+            std::size_t const lit = literals.size();
+            std::size_t const extra = length == 0 ? 0 : length - min_match;
+            out.push_back(std::byte((lit < 15 ? lit : 15) << 4 | (extra < 15 ? extra : 15)));
+            if (lit >= 15) {
+                push_length(out, lit - 15);
+            }
+            out.insert(out.end(), literals.begin(), literals.end());
+            if (length == 0) {
+                return;
+            }
+            out.push_back(std::byte(distance & 0xff));
+            out.push_back(std::byte(distance >> 8));
+            if (extra >= 15) {
+                push_length(out, extra - 15);
+            }
+        }
+
+        consteval auto encode_block(std::vector<std::byte>& out,
+                                    std::span<std::byte const> in,
+                                    compression level) -> void {
+            std::size_t const n = in.size();
+            int const depth = chain_depth(level);
+            std::vector<std::ptrdiff_t> head(std::size_t(1) << hash_bits, -1);
+            std::vector<std::ptrdiff_t> prev(n, -1);
+
+            auto insert = [&](std::size_t i) {
+                std::size_t const h = hash(in, i);
+                prev[i] = head[h];
+                head[h] = std::ptrdiff_t(i);
+            };
+
+            std::size_t anchor = 0;
+            std::size_t i = 0;
+            while (i + min_match <= n) {
+                std::size_t best_length = 0;
+                std::size_t best_distance = 0;
+                std::ptrdiff_t candidate = head[hash(in, i)];
+                for (int d = 0; d < depth && candidate >= 0; ++d) {
+                    std::size_t const c = std::size_t(candidate);
+                    if (i - c > max_distance) {
+                        break;
+                    }
+                    std::size_t length = 0;
+                    while (i + length < n && in[c + length] == in[i + length]) {
+                        ++length;
+                    }
+                    if (length > best_length) {
+                        best_length = length;
+                        best_distance = i - c;
+                    }
+                    candidate = prev[c];
+                }
+
+                insert(i);
+                if (best_length < min_match) {
+                    ++i;
+                    continue;
+                }
+
+                push_sequence(out, in.subspan(anchor, i - anchor), best_distance, best_length);
+                std::size_t const end = i + best_length;
+                // fast skips indexing the interior of matches, which is most of
+                // the compile-time cost on repetitive data
+                if (level != compression::fast) {
+                    for (++i; i < end && i + min_match <= n; ++i) {
+                        insert(i);
+                    }
+                }
+                i = end;
+                anchor = end;
+            }
+            push_sequence(out, in.subspan(anchor), 0, 0);
+        }
+
+        constexpr auto read_length(std::byte const*& in, std::size_t n) -> std::size_t {
+            if (n == 15) {
+                std::size_t b;
+                do {
+                    b = std::to_integer<std::size_t>(*in++);
+                    n += b;
+                } while (b == 255);
+            }
+            return n;
+        }
+
+        // Decodes one block, which must decompress to exactly out.size() bytes
+        constexpr auto decode_block(std::byte const* in, std::span<std::byte> out) -> void {
+            std::byte* o = out.data();
+            std::byte* const end = o + out.size();
+            for (;;) {
+                unsigned const token = std::to_integer<unsigned>(*in++);
+                std::size_t const lit = read_length(in, token >> 4);
+                for (std::size_t k = 0; k != lit; ++k) {
+                    *o++ = *in++;
+                }
+                if (o == end) {
+                    return;
+                }
+
+                std::size_t const distance = std::to_integer<std::size_t>(in[0])
+                    | std::to_integer<std::size_t>(in[1]) << 8;
+                in += 2;
+                std::size_t const length = read_length(in, token & 15) + min_match;
+                // byte at a time, since the source may overlap the destination
+                std::byte const* m = o - distance;
+                for (std::size_t k = 0; k != length; ++k) {
+                    *o++ = *m++;
+                }
+            }
+        }
+    }
+
+    consteval auto compress(std::span<std::byte const> data,
+                            compression level,
+                            std::size_t block_size) -> compressed_image {
+        std::vector<std::byte> bytes;
+        std::vector<std::size_t> offsets = {0};
+        for (std::size_t i = 0; i < data.size(); i += block_size) {
+            auto block = data.subspan(i, std::min(block_size, data.size() - i));
+            if (level == compression::none) {
+                bytes.insert(bytes.end(), block.begin(), block.end());
+            } else {
+                lz::encode_block(bytes, block, level);
+            }
+            offsets.push_back(bytes.size());
+        }
+        return compressed_image{
+            .bytes = std::define_static_array(bytes),
+            .offsets = std::define_static_array(offsets),
+            .size = data.size(),
+        };
+    }
+}
+
+// Embedded binary data, compressed at compile time.
+//
+// Only the compressed image is emitted into the binary (as long as Data itself
+// is not odr-used). The original bytes are available either through data(),
+// which decompresses everything once, on first use, into a zero-initialized
+// static buffer, or block by block through chunks().
+//
+// BlockSize is the granularity of chunks(): smaller blocks mean less memory
+// and latency per chunk, larger blocks give the compressor more history to
+// find matches in.
+template <Param<std::vector<std::byte>> Data,
+          compression Level = compression::balanced,
+          std::size_t BlockSize = 64 * 1024>
+    requires (BlockSize > 0)
+class compressed {
+    static constexpr impl::compressed_image image = impl::compress(*Data, Level, BlockSize);
+
+public:
+    static constexpr compression level = Level;
+    static constexpr std::size_t block_size = BlockSize;
+
+    // The size of the original data
+    static constexpr auto size() -> std::size_t { return image.size; }
+
+    // The size of the embedded compressed image
+    static constexpr auto compressed_size() -> std::size_t { return image.bytes.size(); }
+
+    static constexpr auto block_count() -> std::size_t { return image.offsets.size() - 1; }
+
+    // The compressed image, e.g. for writing out as-is
+    static constexpr auto compressed_bytes() -> std::span<std::byte const> { return image.bytes; }
+
+    // Decompresses block i into out, which must be at least BlockSize bytes, and
+    // returns the part of out that was written.
+    static constexpr auto decompress_block(std::size_t i, std::span<std::byte> out) -> std::span<std::byte> {
+        std::size_t const n = std::min(BlockSize, size() - i * BlockSize);
+        out = out.first(n);
+        std::byte const* in = image.bytes.data() + image.offsets[i];
+        if constexpr (Level == compression::none) {
+            std::copy_n(in, n, out.data());
+        } else {
+            impl::lz::decode_block(in, out);
+        }
+        return out;
+    }
+
+    // Decompresses everything into out, which must be at least size() bytes
+    static constexpr auto decompress(std::span<std::byte> out) -> void {
+        for (std::size_t i = 0; i != block_count(); ++i) {
+            decompress_block(i, out.subspan(i * BlockSize));
+        }
+    }
+
+    // The original data. The first call decompresses it; concurrent first calls
+    // are safe, and every call returns the same buffer.
+    static auto data() -> std::span<std::byte const> {
+        static std::array<std::byte, size()> const& buffer = []() -> auto& {
+            static std::array<std::byte, size()> storage;
+            decompress(storage);
+            return storage;
+        }();
+        return buffer;
+    }
+
+    // An input range over the decompressed blocks, in order. Each chunk is only
+    // valid until the iterator is incremented.
+    class chunk_range {
+        std::vector<std::byte> buffer = std::vector<std::byte>(std::min(BlockSize, size()));
+
+    public:
+        class iterator {
+            chunk_range* range = nullptr;
+            std::size_t block = 0;
+            std::span<std::byte const> chunk;
+
+            auto load() -> void {
+                if (block != block_count()) {
+                    chunk = decompress_block(block, range->buffer);
+                }
+            }
+
+        public:
+            using value_type = std::span<std::byte const>;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::input_iterator_tag;
+
+            iterator() = default;
+            explicit iterator(chunk_range* r) : range(r) { load(); }
+
+            auto operator*() const -> value_type { return chunk; }
+            auto operator++() -> iterator& {
+                ++block;
+                load();
+                return *this;
+            }
+            auto operator++(int) -> void { ++*this; }
+
+            friend auto operator==(iterator const& it, std::default_sentinel_t) -> bool {
+                return it.block == block_count();
+            }
+        };
+
+        auto begin() -> iterator { return iterator(this); }
+        auto end() const -> std::default_sentinel_t { return std::default_sentinel; }
+    };
+
+    static auto chunks() -> chunk_range { return {}; }
+};
+
+}
+
+#endif
+#ifndef CTP_TABLE_HH
+#define CTP_TABLE_HH
+
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mdspan>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ctp {
+
+namespace impl {
+    template <std::size_t> using table_index = std::size_t;
+
+    template <class F, class Extents, class = std::make_index_sequence<Extents::rank()>>
+    struct table_result;
+
+    template <class F, class Extents, std::size_t... Is>
+    struct table_result<F, Extents, std::index_sequence<Is...>> {
+        using type = std::remove_cvref_t<std::invoke_result_t<F const&, table_index<Is>...>>;
+    };
+
+    template <class Extents>
+    consteval auto static_size() -> std::size_t {
+        std::size_t total = 1;
+        for (std::size_t r = 0; r != Extents::rank(); ++r) {
+            total *= Extents::static_extent(r);
+        }
+        return total;
+    }
+
+    // Evaluates f over a row-major multi-dimensional domain and returns the
+    // (shared, static) array of results, as produced by ctp::reflect_constant_array.
+    // Since that array is a template parameter object keyed on its contents, every
+    // table with the same values refers to the same storage.
+    template <class T, class Extents>
+    consteval auto tabulate(auto const& f) -> target<T> const* {
+        constexpr std::size_t rank = Extents::rank();
+        std::vector<T> values;
+        std::array<std::size_t, rank> index = {};
+        for (std::size_t n = 0; n != static_size<Extents>(); ++n) {
+            values.push_back(static_cast<T>(std::apply(f, index)));
+            // odometer increment, last dimension fastest
+            for (std::size_t r = rank; r-- != 0; ) {
+                if (++index[r] != Extents::static_extent(r)) {
+                    break;
+                }
+                index[r] = 0;
+            }
+        }
+        return extract<target<T> const*>(reflect_constant_array(values));
+    }
+}
+
+// A lookup table of F(0), F(1), ..., F(N-1), evaluated at compile time. F can be
+// any callable that is usable in constant evaluation, including a consteval one,
+// and each result is converted to T.
+//
+//      constexpr auto crc32_entry = [](std::size_t i) consteval { ... };
+//      using crc32_table = ctp::table<crc32_entry, 256, std::uint32_t>;
+//
+//      crc = crc32_table::values[(crc ^ byte) & 0xff] ^ (crc >> 8);
+template <auto F,
+          std::size_t N,
+          class T = impl::table_result<decltype(F), std::extents<std::size_t, N>>::type>
+    requires (N > 0)
+struct table {
+    using value_type = target<T>;
+
+    static constexpr std::span<value_type const, N> values{
+        impl::tabulate<T, std::extents<std::size_t, N>>(F), N};
+
+    static constexpr auto size() -> std::size_t { return N; }
+    static constexpr auto data() -> value_type const* { return values.data(); }
+    static constexpr auto begin() { return values.begin(); }
+    static constexpr auto end() { return values.end(); }
+    static constexpr auto operator[](std::size_t i) -> value_type const& { return values[i]; }
+};
+
+// The multi-dimensional form of ctp::table. F is called with one index per
+// dimension of Extents, which must all be static, and the results are stored
+// row-major.
+//
+//      using gamma = ctp::table_nd<[](std::size_t ch, std::size_t v) { ... },
+//                                  std::extents<std::size_t, 3, 256>,
+//                                  std::uint8_t>;
+//      gamma::view[1, v];
+template <auto F,
+          class Extents,
+          class T = impl::table_result<decltype(F), Extents>::type>
+    requires (Extents::rank_dynamic() == 0 && impl::static_size<Extents>() > 0)
+struct table_nd {
+    using value_type = target<T>;
+
+    static constexpr std::mdspan<value_type const, Extents> view{impl::tabulate<T, Extents>(F)};
+
+    static constexpr auto extents() -> Extents { return {}; }
+    static constexpr auto size() -> std::size_t { return view.size(); }
+    static constexpr auto data() -> value_type const* { return view.data_handle(); }
+    static constexpr auto values() -> std::span<value_type const> { return {data(), size()}; }
+};
+
+// What a sampled_table does with an input outside of [Lo, Hi]: clamp it to the
+// nearest end, or treat F as periodic with period Hi - Lo.
+enum class range_reduction {
+    clamp,
+    periodic,
+};
+
+// A table of N evenly spaced samples of F over [Lo, Hi], converted to T, that
+// approximates F for any input by linear interpolation between neighboring
+// samples (rounded to the nearest value, for integral T).
+//
+//      using fast_sin = ctp::sampled_table<sin_impl, 0.0, 2 * pi, 1024,
+//                                          float, ctp::range_reduction::periodic>;
+//      fast_sin{}(angle);
+template <auto F,
+          double Lo,
+          double Hi,
+          std::size_t N,
+          class T = double,
+          range_reduction Reduction = range_reduction::clamp>
+    requires (N >= 2 && Lo < Hi && std::is_arithmetic_v<T>)
+struct sampled_table {
+    static constexpr double step = (Hi - Lo) / (N - 1);
+
+    static constexpr std::span<T const, N> values{
+        impl::tabulate<T, std::extents<std::size_t, N>>(
+            [](std::size_t i) { return F(Lo + step * i); }),
+        N};
+
+    static constexpr auto operator()(double x) -> T {
+        if constexpr (Reduction == range_reduction::periodic) {
+            double periods = (x - Lo) / (Hi - Lo);
+            auto whole = static_cast<long long>(periods);
+            if (whole > periods) {
+                --whole;
+            }
+            x -= whole * (Hi - Lo);
+        } else {
+            x = x < Lo ? Lo : x > Hi ? Hi : x;
+        }
+
+        double const pos = (x - Lo) / step;
+        std::size_t const i = pos < N - 2 ? static_cast<std::size_t>(pos) : N - 2;
+        double const frac = pos - i;
+        // in double, since values[i + 1] - values[i] can wrap for unsigned T
+        double const v = double(values[i]) + (double(values[i + 1]) - double(values[i])) * frac;
+        if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(v < 0 ? v - 0.5 : v + 0.5);
+        } else {
+            return static_cast<T>(v);
+        }
+    }
+};
+
+}
+
+#endif
+#ifndef CTP_IMAGE_HH
+#define CTP_IMAGE_HH
+
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace ctp {
+
+// A ctp::image is a position-independent encoding of a (target) object graph:
+// one contiguous blob, in which every pointer is replaced by an offset from the
+// start of the blob, so that it can be written out and mmap()-ed by another
+// process and read in place through an image_view<T>.
+//
+// The layout is:
+//
+//      header:    "ctp\0", u32 version, u64 type hash, u64 total size
+//      root:      the inline encoding of the root object
+//      out of line data, in the order it was encountered
+//
+// where the inline encoding of a type is:
+//
+//      scalar:           its object representation (sizeof(T) bytes)
+//      string_view:      u64 offset, u64 size (the chars are null-terminated)
+//      span<T>:          u64 offset, u64 size (the elements are inline encodings)
+//      T[N]:             N inline encodings of T
+//      optional<T>:      u8 engaged, then the inline encoding of T
+//      variant<Ts...>:   u64 index, then the inline encoding of the active
+//                        alternative, padded to the size of the largest one
+//      reference_wrapper<T>:
+//                        u64 offset of the inline encoding of the referent,
+//                        which is stored once however many references it has
+//      tuple<Ts...>:     each element's inline encoding, in order
+//      structural class: each non-static data member's inline encoding, in order
+//
+// Nothing is padded, and scalars are in the native byte order, so an image is
+// only meant to be read on the same platform that built it. Pointers, other
+// references, and classes with base classes cannot be encoded. The type hash
+// covers this layout along with the names of class members and enums, so that
+// an image is only opened as a type that encodes the same way and whose members
+// mean the same thing.
+//
+// Views are read-only and lazy, so they do not have the exact API of the
+// target<T> they were built from: members are reached through get<^^C::m>()
+// rather than .m, spans and arrays are random access ranges without data(),
+// and reference_wrapper<T> reads as the view of its referent.
+
+template <class T>
+class image_view;
+
+namespace impl {
+    enum class image_kind {
+        unsupported,
+        scalar,
+        string,
+        span,
+        array,
+        optional,
+        variant,
+        reference,
+        tuple,
+        aggregate,
+    };
+
+    template <class T>
+    consteval auto image_kind_of() -> image_kind {
+        if constexpr (std::is_arithmetic_v<T> or std::is_enum_v<T>) {
+            return image_kind::scalar;
+        } else if constexpr (std::same_as<T, std::string_view>) {
+            return image_kind::string;
+        } else if constexpr (std::is_bounded_array_v<T>) {
+            return image_kind::array;
+        } else if constexpr (not is_class_type(^^T)) {
+            return image_kind::unsupported;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::span) {
+            return image_kind::span;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::optional) {
+            return image_kind::optional;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::variant) {
+            return image_kind::variant;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::reference_wrapper) {
+            return image_kind::reference;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::tuple) {
+            return image_kind::tuple;
+        } else if constexpr (is_structural_type(^^T)) {
+            return image_kind::aggregate;
+        } else {
+            return image_kind::unsupported;
+        }
+    }
+
+    template <class T>
+    inline constexpr image_kind image_kind_v = image_kind_of<std::remove_cv_t<T>>();
+
+    template <class T>
+    consteval auto image_members() -> std::span<std::meta::info const> {
+        return std::define_static_array(
+            nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+    }
+
+    inline constexpr std::uint32_t image_version = 2;
+    inline constexpr std::size_t image_header_size = 24;
+
+    // The number of bytes T occupies where it is stored, not counting anything
+    // that it points to
+    template <class T>
+    consteval auto image_inline_size() -> std::size_t {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        static_assert(kind != image_kind::unsupported, "this type cannot be stored in a ctp::image");
+        if constexpr (kind == image_kind::scalar) {
+            return sizeof(U);
+        } else if constexpr (kind == image_kind::string or kind == image_kind::span) {
+            return 2 * sizeof(std::uint64_t);
+        } else if constexpr (kind == image_kind::array) {
+            return std::extent_v<U> * image_inline_size<std::remove_extent_t<U>>();
+        } else if constexpr (kind == image_kind::optional) {
+            return 1 + image_inline_size<typename U::value_type>();
+        } else if constexpr (kind == image_kind::variant) {
+            return []<std::size_t... Is>(std::index_sequence<Is...>) {
+                return sizeof(std::uint64_t)
+                    + std::max({image_inline_size<std::variant_alternative_t<Is, U>>()...});
+            }(std::make_index_sequence<std::variant_size_v<U>>());
+        } else if constexpr (kind == image_kind::reference) {
+            return sizeof(std::uint64_t);
+        } else if constexpr (kind == image_kind::tuple) {
+            return []<std::size_t... Is>(std::index_sequence<Is...>) {
+                return (0zu + ... + image_inline_size<std::tuple_element_t<Is, U>>());
+            }(std::make_index_sequence<std::tuple_size_v<U>>());
+        } else {
+            static_assert(bases_of(^^U, std::meta::access_context::unchecked()).empty(),
+                          "classes with base classes cannot be stored in a ctp::image");
+            std::size_t n = 0;
+            template for (constexpr std::meta::info m : image_members<U>()) {
+                static_assert(not is_reference_type(type_of(m)), "references cannot be stored in a ctp::image");
+                n += image_inline_size<typename [: type_of(m) :]>();
+            }
+            return n;
+        }
+    }
+
+    // The offset of the I-th element (of a tuple) or member (of a class)
+    template <class T, std::size_t I>
+    consteval auto image_field_offset() -> std::size_t {
+        std::size_t n = 0;
+        if constexpr (image_kind_v<T> == image_kind::tuple) {
+            template for (constexpr std::size_t J : std::views::iota(0zu, I)) {
+                n += image_inline_size<std::tuple_element_t<J, T>>();
+            }
+        } else {
+            template for (constexpr std::size_t J : std::views::iota(0zu, I)) {
+                n += image_inline_size<typename [: type_of(image_members<T>()[J]) :]>();
+            }
+        }
+        return n;
+    }
+
+    // FNV-1a over the bytes of v, which is all that is needed to tell images of
+    // different layouts apart
+    consteval auto image_hash(std::uint64_t h, std::uint64_t v) -> std::uint64_t {
+        for (int i = 0; i != 8; ++i) {
+            h = (h ^ ((v >> (8 * i)) & 0xff)) * 0x100000001b3;
+        }
+        return h;
+    }
+
+    consteval auto image_hash(std::uint64_t h, std::string_view s) -> std::uint64_t {
+        h = image_hash(h, s.size());
+        for (char c : s) {
+            h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+        }
+        return h;
+    }
+
+    consteval auto image_name_of(std::meta::info r) -> std::string_view {
+        return has_identifier(r) ? identifier_of(r) : std::string_view();
+    }
+
+    // How a scalar is to be interpreted: 0 for unsigned, 1 for signed, 2 for
+    // floating point
+    template <class T>
+    consteval auto image_scalar_class() -> std::uint64_t {
+        if constexpr (std::is_enum_v<T>) {
+            return image_scalar_class<std::underlying_type_t<T>>();
+        } else {
+            return std::is_floating_point_v<T> ? 2 : std::is_signed_v<T> ? 1 : 0;
+        }
+    }
+
+    // Hashes the encoding of T: its kind and inline size, and then the same for
+    // everything it is made of, along with the name of every class member and
+    // enum, so that classes that merely encode the same way are told apart
+    template <class T>
+    consteval auto image_layout_hash(std::uint64_t h = 0xcbf29ce484222325) -> std::uint64_t {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        h = image_hash(h, std::uint64_t(kind));
+        h = image_hash(h, image_inline_size<U>());
+        if constexpr (kind == image_kind::scalar) {
+            h = image_hash(h, image_scalar_class<U>());
+            if constexpr (std::is_enum_v<U>) {
+                h = image_hash(h, image_name_of(^^U));
+            }
+        } else if constexpr (kind == image_kind::span) {
+            h = image_layout_hash<typename U::element_type>(h);
+        } else if constexpr (kind == image_kind::array) {
+            h = image_hash(h, std::extent_v<U>);
+            h = image_layout_hash<std::remove_extent_t<U>>(h);
+        } else if constexpr (kind == image_kind::optional) {
+            h = image_layout_hash<typename U::value_type>(h);
+        } else if constexpr (kind == image_kind::variant) {
+            h = image_hash(h, std::variant_size_v<U>);
+            template for (constexpr std::size_t I : std::views::iota(0zu, std::variant_size_v<U>)) {
+                h = image_layout_hash<std::variant_alternative_t<I, U>>(h);
+            }
+        } else if constexpr (kind == image_kind::reference) {
+            h = image_layout_hash<typename U::type>(h);
+        } else if constexpr (kind == image_kind::tuple) {
+            h = image_hash(h, std::tuple_size_v<U>);
+            template for (constexpr std::size_t I : std::views::iota(0zu, std::tuple_size_v<U>)) {
+                h = image_layout_hash<std::tuple_element_t<I, U>>(h);
+            }
+        } else if constexpr (kind == image_kind::aggregate) {
+            h = image_hash(h, image_members<U>().size());
+            template for (constexpr std::meta::info m : image_members<U>()) {
+                h = image_hash(h, image_name_of(m));
+                h = image_layout_hash<typename [: type_of(m) :]>(h);
+            }
+        }
+        return h;
+    }
+
+    template <class T>
+    inline constexpr std::uint64_t image_type_hash = image_layout_hash<T>();
+
+    template <class T>
+    constexpr auto image_read(char const* p) -> T {
+        std::array<char, sizeof(T)> bytes;
+        std::copy_n(p, sizeof(T), bytes.begin());
+        return std::bit_cast<T>(bytes);
+    }
+
+    class image_writer {
+        // Each object that a reference_wrapper refers to, and where it was
+        // written. The type is part of the key, since a class and its first
+        // member share an address.
+        struct referent {
+            void const* address;
+            std::meta::info type;
+            std::size_t offset;
+        };
+
+        std::vector<char> out;
+        std::vector<referent> referents;
+
+    public:
+        consteval auto size() const -> std::size_t { return out.size(); }
+        consteval auto bytes() const -> std::vector<char> const& { return out; }
+
+        // Reserves n bytes at the end, returning their offset
+        consteval auto allocate(std::size_t n) -> std::size_t {
+            std::size_t const at = out.size();
+            out.resize(at + n);
+            return at;
+        }
+
+        template <class T>
+        consteval auto write_scalar(std::size_t at, T v) -> void {
+            auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(v);
+            std::ranges::copy(bytes, out.begin() + at);
+        }
+
+        template <class T>
+        consteval auto write(std::size_t at, T const& v) -> void {
+            constexpr image_kind kind = image_kind_v<T>;
+            if constexpr (kind == image_kind::scalar) {
+                write_scalar(at, v);
+            } else if constexpr (kind == image_kind::string) {
+                std::size_t const offset = allocate(v.size() + 1);
+                std::ranges::copy(v, out.begin() + offset);
+                write_scalar<std::uint64_t>(at, offset);
+                write_scalar<std::uint64_t>(at + 8, v.size());
+            } else if constexpr (kind == image_kind::span) {
+                using E = std::remove_cv_t<typename T::element_type>;
+                constexpr std::size_t stride = image_inline_size<E>();
+                std::size_t const offset = allocate(v.size() * stride);
+                for (std::size_t i = 0; i != v.size(); ++i) {
+                    write<E>(offset + i * stride, v[i]);
+                }
+                write_scalar<std::uint64_t>(at, offset);
+                write_scalar<std::uint64_t>(at + 8, v.size());
+            } else if constexpr (kind == image_kind::array) {
+                using E = std::remove_cv_t<std::remove_extent_t<T>>;
+                constexpr std::size_t stride = image_inline_size<E>();
+                for (std::size_t i = 0; i != std::extent_v<T>; ++i) {
+                    write<E>(at + i * stride, v[i]);
+                }
+            } else if constexpr (kind == image_kind::optional) {
+                write_scalar<std::uint8_t>(at, v.has_value());
+                if (v) {
+                    write<typename T::value_type>(at + 1, *v);
+                }
+            } else if constexpr (kind == image_kind::variant) {
+                write_scalar<std::uint64_t>(at, v.index());
+                template for (constexpr std::size_t I : std::views::iota(0zu, std::variant_size_v<T>)) {
+                    if (I == v.index()) {
+                        write<std::remove_cv_t<std::variant_alternative_t<I, T>>>(at + 8, std::get<I>(v));
+                    }
+                }
+            } else if constexpr (kind == image_kind::reference) {
+                using R = std::remove_cv_t<typename T::type>;
+                void const* const address = std::addressof(v.get());
+                auto const known = std::ranges::find_if(referents, [&](referent const& r) {
+                    return r.address == address and r.type == ^^R;
+                });
+                std::size_t offset;
+                if (known != referents.end()) {
+                    offset = known->offset;
+                } else {
+                    // registered before it is written, so that a cycle ends here
+                    offset = allocate(image_inline_size<R>());
+                    referents.push_back({address, ^^R, offset});
+                    write<R>(offset, v.get());
+                }
+                write_scalar<std::uint64_t>(at, offset);
+            } else if constexpr (kind == image_kind::tuple) {
+                template for (constexpr std::size_t I : std::views::iota(0zu, std::tuple_size_v<T>)) {
+                    write<std::tuple_element_t<I, T>>(at + image_field_offset<T, I>(), std::get<I>(v));
+                }
+            } else {
+                template for (constexpr std::size_t I : std::views::iota(0zu, image_members<T>().size())) {
+                    constexpr std::meta::info m = image_members<T>()[I];
+                    write<std::remove_cv_t<typename [: type_of(m) :]>>(
+                        at + image_field_offset<T, I>(), v.[: m :]);
+                }
+            }
+        }
+    };
+
+    template <class T>
+    consteval auto make_image(T const& v) -> std::span<char const> {
+        image_writer w;
+        w.allocate(image_header_size + image_inline_size<T>());
+        w.write(image_header_size, v);
+
+        w.write_scalar<std::array<char, 4>>(0, {'c', 't', 'p', '\0'});
+        w.write_scalar<std::uint32_t>(4, image_version);
+        w.write_scalar<std::uint64_t>(8, image_type_hash<T>);
+        w.write_scalar<std::uint64_t>(16, w.size());
+        return std::define_static_array(w.bytes());
+    }
+
+    // What reading a T out of an image gives back: scalars and strings are
+    // read directly, everything else is a view
+    template <class T>
+    constexpr auto image_load(char const* base, std::size_t pos) {
+        using U = std::remove_cv_t<T>;
+        if constexpr (image_kind_v<U> == image_kind::scalar) {
+            return image_read<U>(base + pos);
+        } else if constexpr (image_kind_v<U> == image_kind::string) {
+            return std::string_view(base + image_read<std::uint64_t>(base + pos),
+                                    image_read<std::uint64_t>(base + pos + 8));
+        } else if constexpr (image_kind_v<U> == image_kind::reference) {
+            return image_load<typename U::type>(base, image_read<std::uint64_t>(base + pos));
+        } else {
+            return image_view<U>(base, pos);
+        }
+    }
+
+    template <class T>
+    using image_value_t = decltype(image_load<T>(nullptr, 0));
+
+    // Whether the encoding of T contains any offsets or variant indices, i.e.
+    // whether there is anything for image_check to do
+    template <class T>
+    consteval auto image_needs_check() -> bool {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        if constexpr (kind == image_kind::scalar) {
+            return false;
+        } else if constexpr (kind == image_kind::string
+                          or kind == image_kind::span
+                          or kind == image_kind::variant
+                          or kind == image_kind::reference) {
+            return true;
+        } else if constexpr (kind == image_kind::array) {
+            return image_needs_check<std::remove_extent_t<U>>();
+        } else if constexpr (kind == image_kind::optional) {
+            return image_needs_check<typename U::value_type>();
+        } else if constexpr (kind == image_kind::tuple) {
+            return []<std::size_t... Is>(std::index_sequence<Is...>) {
+                return (false or ... or image_needs_check<std::tuple_element_t<Is, U>>());
+            }(std::make_index_sequence<std::tuple_size_v<U>>());
+        } else {
+            bool any = false;
+            template for (constexpr std::meta::info m : image_members<U>()) {
+                any = any or image_needs_check<typename [: type_of(m) :]>();
+            }
+            return any;
+        }
+    }
+
+    // The referents that image_check has already checked, by offset and type
+    // hash, so that each is checked once and cycles terminate
+    class image_visited {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> seen;
+
+    public:
+        // Whether this is the first visit
+        constexpr auto insert(std::uint64_t offset, std::uint64_t type) -> bool {
+            std::pair const key(offset, type);
+            auto const it = std::ranges::lower_bound(seen, key);
+            if (it != seen.end() and *it == key) {
+                return false;
+            }
+            seen.insert(it, key);
+            return true;
+        }
+    };
+
+    template <class T>
+    constexpr auto image_check(char const* base, std::size_t pos, std::size_t total, image_visited& seen) -> bool;
+
+    // Checks the active alternative of the variant at pos, whose index is
+    // already known to be valid
+    template <class T, std::size_t... Is>
+    constexpr auto image_check_alternative(char const* base, std::size_t pos, std::size_t total,
+                                           image_visited& seen, std::uint64_t index,
+                                           std::index_sequence<Is...>) -> bool {
+        return ((index == Is and image_check<std::variant_alternative_t<Is, T>>(base, pos + 8, total, seen)) or ...);
+    }
+
+    // Checks that everything the T at pos (whose inline encoding is already
+    // known to be in bounds) refers to lies within the first total bytes, and
+    // that every variant index is valid
+    template <class T>
+    constexpr auto image_check(char const* base, std::size_t pos, std::size_t total, image_visited& seen) -> bool {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        if constexpr (not image_needs_check<U>()) {
+            return true;
+        } else if constexpr (kind == image_kind::string) {
+            std::uint64_t const offset = image_read<std::uint64_t>(base + pos);
+            std::uint64_t const size = image_read<std::uint64_t>(base + pos + 8);
+            // the chars and their null terminator
+            return offset < total and size < total - offset;
+        } else if constexpr (kind == image_kind::span) {
+            using E = std::remove_cv_t<typename U::element_type>;
+            constexpr std::size_t stride = image_inline_size<E>();
+            std::uint64_t const offset = image_read<std::uint64_t>(base + pos);
+            std::uint64_t const size = image_read<std::uint64_t>(base + pos + 8);
+            if constexpr (stride == 0) {
+                return offset <= total;
+            } else {
+                if (offset > total or size > (total - offset) / stride) {
+                    return false;
+                }
+                if constexpr (image_needs_check<E>()) {
+                    for (std::size_t i = 0; i != size; ++i) {
+                        if (not image_check<E>(base, offset + i * stride, total, seen)) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+        } else if constexpr (kind == image_kind::array) {
+            using E = std::remove_cv_t<std::remove_extent_t<U>>;
+            constexpr std::size_t stride = image_inline_size<E>();
+            for (std::size_t i = 0; i != std::extent_v<U>; ++i) {
+                if (not image_check<E>(base, pos + i * stride, total, seen)) {
+                    return false;
+                }
+            }
+            return true;
+        } else if constexpr (kind == image_kind::optional) {
+            return image_read<std::uint8_t>(base + pos) == 0
+                or image_check<typename U::value_type>(base, pos + 1, total, seen);
+        } else if constexpr (kind == image_kind::variant) {
+            std::uint64_t const index = image_read<std::uint64_t>(base + pos);
+            return index < std::variant_size_v<U>
+                and image_check_alternative<U>(base, pos, total, seen, index,
+                                               std::make_index_sequence<std::variant_size_v<U>>());
+        } else if constexpr (kind == image_kind::reference) {
+            using R = std::remove_cv_t<typename U::type>;
+            std::uint64_t const offset = image_read<std::uint64_t>(base + pos);
+            if (offset > total or image_inline_size<R>() > total - offset) {
+                return false;
+            }
+            return not seen.insert(offset, image_type_hash<R>) or image_check<R>(base, offset, total, seen);
+        } else if constexpr (kind == image_kind::tuple) {
+            bool ok = true;
+            template for (constexpr std::size_t I : std::views::iota(0zu, std::tuple_size_v<U>)) {
+                ok = ok and image_check<std::tuple_element_t<I, U>>(base, pos + image_field_offset<U, I>(), total, seen);
+            }
+            return ok;
+        } else {
+            bool ok = true;
+            template for (constexpr std::size_t I : std::views::iota(0zu, image_members<U>().size())) {
+                ok = ok and image_check<typename [: type_of(image_members<U>()[I]) :]>(
+                    base, pos + image_field_offset<U, I>(), total, seen);
+            }
+            return ok;
+        }
+    }
+
+    // Random access over n consecutive inline encodings of T
+    template <class T>
+    class image_range {
+        static constexpr std::size_t stride = image_inline_size<T>();
+
+        char const* base_ = nullptr;
+        std::size_t pos_ = 0;
+        std::size_t size_ = 0;
+
+    public:
+        class iterator {
+            char const* base = nullptr;
+            std::size_t pos = 0;
+
+        public:
+            using value_type = image_value_t<T>;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::random_access_iterator_tag;
+
+            constexpr iterator() = default;
+            constexpr iterator(char const* b, std::size_t p) : base(b), pos(p) { }
+
+            constexpr auto operator*() const -> value_type { return image_load<T>(base, pos); }
+            constexpr auto operator[](difference_type n) const -> value_type { return *(*this + n); }
+
+            constexpr auto operator++() -> iterator& { pos += stride; return *this; }
+            constexpr auto operator++(int) -> iterator { auto tmp = *this; ++*this; return tmp; }
+            constexpr auto operator--() -> iterator& { pos -= stride; return *this; }
+            constexpr auto operator--(int) -> iterator { auto tmp = *this; --*this; return tmp; }
+            constexpr auto operator+=(difference_type n) -> iterator& { pos += n * stride; return *this; }
+            constexpr auto operator-=(difference_type n) -> iterator& { pos -= n * stride; return *this; }
+
+            friend constexpr auto operator+(iterator it, difference_type n) -> iterator { return it += n; }
+            friend constexpr auto operator+(difference_type n, iterator it) -> iterator { return it += n; }
+            friend constexpr auto operator-(iterator it, difference_type n) -> iterator { return it -= n; }
+            friend constexpr auto operator-(iterator const& a, iterator const& b) -> difference_type {
+                return (difference_type(a.pos) - difference_type(b.pos)) / difference_type(stride);
+            }
+            friend constexpr auto operator==(iterator const& a, iterator const& b) -> bool { return a.pos == b.pos; }
+            friend constexpr auto operator<=>(iterator const& a, iterator const& b) { return a.pos <=> b.pos; }
+        };
+
+        constexpr image_range() = default;
+        constexpr image_range(char const* base, std::size_t pos, std::size_t size)
+            : base_(base), pos_(pos), size_(size) { }
+
+        constexpr auto size() const -> std::size_t { return size_; }
+        constexpr auto empty() const -> bool { return size_ == 0; }
+        constexpr auto operator[](std::size_t i) const -> image_value_t<T> {
+            return image_load<T>(base_, pos_ + i * stride);
+        }
+        constexpr auto front() const -> image_value_t<T> { return (*this)[0]; }
+        constexpr auto back() const -> image_value_t<T> { return (*this)[size_ - 1]; }
+        constexpr auto begin() const -> iterator { return iterator(base_, pos_); }
+        constexpr auto end() const -> iterator { return iterator(base_, pos_ + size_ * stride); }
+    };
+}
+
+// Reading a span<T> in an image gives a random access range of T (or of views of T)
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::span)
+class image_view<T> : public impl::image_range<std::remove_cv_t<typename T::element_type>> {
+public:
+    constexpr image_view(char const* base, std::size_t pos)
+        : impl::image_range<std::remove_cv_t<typename T::element_type>>(
+            base,
+            impl::image_read<std::uint64_t>(base + pos),
+            impl::image_read<std::uint64_t>(base + pos + 8))
+    { }
+};
+
+// Likewise for T[N]
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::array)
+class image_view<T> : public impl::image_range<std::remove_cv_t<std::remove_extent_t<T>>> {
+public:
+    constexpr image_view(char const* base, std::size_t pos)
+        : impl::image_range<std::remove_cv_t<std::remove_extent_t<T>>>(base, pos, std::extent_v<T>)
+    { }
+};
+
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::optional)
+class image_view<T> {
+    char const* base;
+    std::size_t pos;
+
+public:
+    constexpr image_view(char const* b, std::size_t p) : base(b), pos(p) { }
+
+    constexpr auto has_value() const -> bool { return impl::image_read<std::uint8_t>(base + pos) != 0; }
+    constexpr explicit operator bool() const { return has_value(); }
+    constexpr auto operator*() const -> impl::image_value_t<typename T::value_type> {
+        return impl::image_load<typename T::value_type>(base, pos + 1);
+    }
+    constexpr auto value() const -> impl::image_value_t<typename T::value_type> {
+        if (not has_value()) {
+            throw std::bad_optional_access();
+        }
+        return **this;
+    }
+};
+
+// Reading a variant gives its index() and get<I>(), which throws
+// std::bad_variant_access unless I is the index
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::variant)
+class image_view<T> {
+    char const* base;
+    std::size_t pos;
+
+public:
+    constexpr image_view(char const* b, std::size_t p) : base(b), pos(p) { }
+
+    constexpr auto index() const -> std::size_t {
+        return std::size_t(impl::image_read<std::uint64_t>(base + pos));
+    }
+
+    template <std::size_t I>
+    constexpr auto get() const -> impl::image_value_t<std::variant_alternative_t<I, T>> {
+        if (index() != I) {
+            throw std::bad_variant_access();
+        }
+        return impl::image_load<std::variant_alternative_t<I, T>>(base, pos + 8);
+    }
+
+    template <std::size_t I>
+    friend constexpr auto get(image_view const& v) { return v.template get<I>(); }
+};
+
+// Tuples and structural classes: get<I>() for the I-th element or member, and
+// for classes get<^^C::m>() as well
+template <class T>
+    requires (impl::image_kind_v<T> == impl::image_kind::tuple
+           or impl::image_kind_v<T> == impl::image_kind::aggregate)
+class image_view<T> {
+    char const* base;
+    std::size_t pos;
+
+    template <std::size_t I>
+    static consteval auto field_type() -> std::meta::info {
+        if constexpr (impl::image_kind_v<T> == impl::image_kind::tuple) {
+            return ^^std::tuple_element_t<I, T>;
+        } else {
+            return remove_cv(type_of(impl::image_members<T>()[I]));
+        }
+    }
+
+public:
+    constexpr image_view(char const* b, std::size_t p) : base(b), pos(p) { }
+
+    template <std::size_t I>
+    constexpr auto get() const {
+        return impl::image_load<typename [: field_type<I>() :]>(base, pos + impl::image_field_offset<T, I>());
+    }
+
+    template <std::meta::info M>
+        requires (impl::image_kind_v<T> == impl::image_kind::aggregate)
+    constexpr auto get() const {
+        constexpr std::size_t I = [] {
+            auto members = impl::image_members<T>();
+            return std::size_t(std::ranges::find(members, M) - members.begin());
+        }();
+        static_assert(I != impl::image_members<T>().size(), "not a non-static data member of T");
+        return get<I>();
+    }
+
+    template <std::size_t I>
+    friend constexpr auto get(image_view const& v) { return v.template get<I>(); }
+};
+
+// Checks that bytes holds an image of a T (as produced by ctp::image) and
+// returns a view of its root, or nullopt if it does not. Besides the header,
+// every offset and size in the image is checked against its total size, so
+// that nothing read through the view can go out of bounds, and every variant
+// index against its number of alternatives. This takes time linear in the
+// number of strings, span elements, and referents in the image.
+template <class T>
+constexpr auto open_image(std::span<char const> bytes) -> std::optional<impl::image_value_t<T>> {
+    if (bytes.size() < impl::image_header_size
+        or not std::ranges::equal(bytes.first(4), std::array{'c', 't', 'p', '\0'})
+        or impl::image_read<std::uint32_t>(bytes.data() + 4) != impl::image_version
+        or impl::image_read<std::uint64_t>(bytes.data() + 8) != impl::image_type_hash<T>) {
+        return std::nullopt;
+    }
+    std::uint64_t const total = impl::image_read<std::uint64_t>(bytes.data() + 16);
+    impl::image_visited seen;
+    if (total > bytes.size()
+        or total < impl::image_header_size + impl::image_inline_size<T>()
+        or not impl::image_check<T>(bytes.data(), impl::image_header_size, total, seen)) {
+        return std::nullopt;
+    }
+    return impl::image_load<T>(bytes.data(), impl::image_header_size);
+}
+
+template <class T>
+auto open_image(std::span<std::byte const> bytes) -> std::optional<impl::image_value_t<T>> {
+    return open_image<T>(std::span(reinterpret_cast<char const*>(bytes.data()), bytes.size()));
+}
+
+// The image of the value of the ctp::Param V, built at compile time
+//
+//      using config_image = ctp::image<Config{...}>;
+//      write(fd, config_image::bytes.data(), config_image::bytes.size());
+//
+//      // elsewhere, on the mmap()-ed file:
+//      auto config = ctp::open_image<config_image::type>(mapped);
+template <Param V>
+struct image {
+    using type = decltype(V)::type;
+
+    static constexpr std::span<char const> bytes = impl::make_image<type>(V.get());
+
+    static constexpr auto size() -> std::size_t { return bytes.size(); }
+    static constexpr auto root() -> impl::image_value_t<type> {
+        return impl::image_load<type>(bytes.data(), impl::image_header_size);
+    }
+};
+
+}
+
+#endif
+#ifndef CTP_KERNELS_HH
+#define CTP_KERNELS_HH
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ctp {
+
+// Numeric kernels whose coefficients are template parameters. Every loop over
+// the coefficients is unrolled at compile time, terms with a zero coefficient
+// are dropped, and multiplications by 1, -1, and 2 become a copy, a negation,
+// and an addition. The loops over the data are left as simple counted loops
+// for the compiler to vectorize.
+
+namespace impl {
+    template <double C, class T>
+    constexpr auto scale(T const& v) -> T {
+        if constexpr (C == 1) {
+            return v;
+        } else if constexpr (C == -1) {
+            return -v;
+        } else if constexpr (C == 2) {
+            return v + v;
+        } else {
+            return T(C) * v;
+        }
+    }
+
+    // acc + C * v, for a non-zero C
+    template <double C, class T>
+    constexpr auto multiply_add(T const& acc, T const& v) -> T {
+        if constexpr (C == -1) {
+            return acc - v;
+        } else {
+            return acc + scale<C>(v);
+        }
+    }
+
+    // The number of coefficients, ignoring any trailing zeroes
+    consteval auto significant_size(std::span<double const> cs) -> std::size_t {
+        std::size_t n = cs.size();
+        while (n != 0 and cs[n - 1] == 0) {
+            --n;
+        }
+        return n;
+    }
+
+    // Whether every coefficient survives conversion to T, which is only in
+    // question for integral T
+    template <class T>
+    consteval auto exactly_representable(std::span<double const> cs) -> bool {
+        if constexpr (std::is_integral_v<T>) {
+            return std::ranges::all_of(cs, [](double c){
+                // max() / 2 + 1 is a power of two, so this bound is exact
+                return c >= double(std::numeric_limits<T>::lowest())
+                   and c < 2 * double(std::numeric_limits<T>::max() / 2 + 1)
+                   and double(T(c)) == c;
+            });
+        } else {
+            return true;
+        }
+    }
+}
+
+// The polynomial Coeffs[0] + Coeffs[1] * x + Coeffs[2] * x^2 + ...,
+// evaluated with Horner's method
+template <Param<std::vector<double>> Coeffs>
+struct polynomial {
+    static constexpr std::size_t degree_bound = impl::significant_size(*Coeffs);
+
+    template <class T>
+    static constexpr auto operator()(T const& x) -> T {
+        static_assert(impl::exactly_representable<T>(*Coeffs),
+                      "every coefficient must be exactly representable as T");
+        if constexpr (degree_bound == 0) {
+            return T(0);
+        } else {
+            constexpr std::size_t d = degree_bound - 1;
+            if constexpr (d == 0) {
+                return T((*Coeffs)[0]);
+            } else {
+                // the leading term, c[d] * x, without a separate multiplication
+                T r = impl::scale<(*Coeffs)[d]>(x);
+                template for (constexpr std::size_t k : std::views::iota(1zu, d + 1)) {
+                    constexpr std::size_t i = d - k;
+                    constexpr double c = (*Coeffs)[i];
+                    if constexpr (c != 0) {
+                        r = r + T(c);
+                    }
+                    if constexpr (i != 0) {
+                        r = r * x;
+                    }
+                }
+                return r;
+            }
+        }
+    }
+
+    template <class T>
+    static constexpr auto apply(std::span<T const> in, std::span<T> out) -> void {
+        for (std::size_t i = 0; i != in.size(); ++i) {
+            out[i] = operator()(in[i]);
+        }
+    }
+};
+
+// A finite impulse response filter: out[i] = sum over k of Taps[k] * in[i + N - 1 - k],
+// for the N taps. Only full windows are produced, so out must have room for
+// in.size() - N + 1 values.
+template <Param<std::vector<double>> Taps>
+    requires (Taps->size() > 0)
+struct fir {
+    static constexpr std::size_t size = Taps->size();
+
+    template <class T>
+    static constexpr auto at(T const* window) -> T {
+        static_assert(impl::exactly_representable<T>(*Taps),
+                      "every tap must be exactly representable as T");
+        T acc = T(0);
+        template for (constexpr std::size_t k : std::views::iota(0zu, size)) {
+            constexpr double c = (*Taps)[k];
+            if constexpr (c != 0) {
+                acc = impl::multiply_add<c>(acc, window[size - 1 - k]);
+            }
+        }
+        return acc;
+    }
+
+    template <class T>
+    static constexpr auto apply(std::span<T const> in, std::span<T> out) -> void {
+        if (in.size() < size) {
+            return;
+        }
+        std::size_t const n = in.size() - size + 1;
+        for (std::size_t i = 0; i != n; ++i) {
+            out[i] = at(in.data() + i);
+        }
+    }
+};
+
+// Multiplication by the constant matrix M, given as a non-empty vector of
+// non-empty rows
+template <Param<std::vector<std::vector<double>>> M>
+    requires (M->size() > 0 and (*M)[0].size() > 0)
+struct matvec {
+    static constexpr std::size_t rows = M->size();
+    static constexpr std::size_t cols = (*M)[0].size();
+
+    static_assert([]{
+        for (auto row : *M) {
+            if (row.size() != cols) {
+                return false;
+            }
+        }
+        return true;
+    }(), "every row of M must have the same size");
+
+    template <class T>
+    static constexpr auto operator()(std::array<T, cols> const& x) -> std::array<T, rows> {
+        static_assert(std::ranges::all_of(*M, [](auto const& row){ return impl::exactly_representable<T>(row); }),
+                      "every entry of M must be exactly representable as T");
+        std::array<T, rows> y;
+        template for (constexpr std::size_t r : std::views::iota(0zu, rows)) {
+            T acc = T(0);
+            template for (constexpr std::size_t c : std::views::iota(0zu, cols)) {
+                constexpr double m = (*M)[r][c];
+                if constexpr (m != 0) {
+                    acc = impl::multiply_add<m>(acc, x[c]);
+                }
+            }
+            y[r] = acc;
+        }
+        return y;
+    }
+
+    // Applies the matrix to each of in.size() / cols vectors stored back to back
+    template <class T>
+    static constexpr auto apply(std::span<T const> in, std::span<T> out) -> void {
+        for (std::size_t v = 0; v != in.size() / cols; ++v) {
+            std::array<T, cols> x;
+            std::copy_n(in.data() + v * cols, cols, x.begin());
+            auto const y = operator()(x);
+            std::copy_n(y.begin(), rows, out.data() + v * rows);
+        }
+    }
+};
+
+}
+
+#endif
+#ifndef CTP_FUSE_FILTER_HH
+#define CTP_FUSE_FILTER_HH
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctp {
+
+namespace impl {
+    namespace fuse {
+        // Binary fuse filters, from "Binary Fuse Filters: Fast and Smaller Than
+        // Xor Filters" (Graf and Lemire), with 8-bit fingerprints and 3 hashes
+        struct layout {
+            std::uint64_t seed;
+            std::uint32_t segment_length;
+            std::uint32_t segment_length_mask;
+            std::uint32_t segment_count_length;
+            std::uint32_t array_length;
+        };
+
+        constexpr auto murmur64(std::uint64_t h) -> std::uint64_t {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccd;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53;
+            h ^= h >> 33;
+            return h;
+        }
+
+        // The high 64 bits of a * b, from 32-bit halves, so as not to need a
+        // 128-bit integer type
+        constexpr auto mulhi(std::uint64_t a, std::uint64_t b) -> std::uint64_t {
+            std::uint64_t const a_lo = a & 0xffffffff;
+            std::uint64_t const a_hi = a >> 32;
+            std::uint64_t const b_lo = b & 0xffffffff;
+            std::uint64_t const b_hi = b >> 32;
+
+            std::uint64_t const lo_lo = a_lo * b_lo;
+            std::uint64_t const hi_lo = a_hi * b_lo;
+            std::uint64_t const lo_hi = a_lo * b_hi;
+            std::uint64_t const hi_hi = a_hi * b_hi;
+
+            // the middle column, with the carry out of the low 32 bits
+            std::uint64_t const middle = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+            return hi_hi + (hi_lo >> 32) + (middle >> 32);
+        }
+
+        constexpr auto fingerprint(std::uint64_t hash) -> std::uint8_t {
+            return static_cast<std::uint8_t>(hash ^ (hash >> 32));
+        }
+
+        constexpr auto positions(layout const& l, std::uint64_t hash) -> std::array<std::uint32_t, 3> {
+            std::uint64_t const h0 = mulhi(hash, l.segment_count_length);
+            std::uint64_t const h1 = (h0 + l.segment_length) ^ ((hash >> 18) & l.segment_length_mask);
+            std::uint64_t const h2 = (h0 + 2 * l.segment_length) ^ (hash & l.segment_length_mask);
+            return {std::uint32_t(h0), std::uint32_t(h1), std::uint32_t(h2)};
+        }
+
+        // The natural logarithm, since std::log is not usable at compile time
+        consteval auto ln(double x) -> double {
+            int e = 0;
+            for (; x >= 2; x /= 2) {
+                ++e;
+            }
+            for (; x < 1; x *= 2) {
+                --e;
+            }
+            double const y = (x - 1) / (x + 1);
+            double term = y;
+            double sum = 0;
+            for (int k = 1; k < 64; k += 2) {
+                sum += term / k;
+                term *= y * y;
+            }
+            return 2 * sum + e * 0.6931471805599453;
+        }
+
+        // The sizing from the reference implementation, which gives about 1.125
+        // slots per key for large key counts
+        consteval auto make_layout(std::uint32_t size) -> layout {
+            constexpr std::uint32_t arity = 3;
+            layout l = {};
+            l.segment_length = size == 0
+                ? 4
+                : std::uint32_t(1) << int(ln(size) / ln(3.33) + 2.25);
+            if (l.segment_length > 262144) {
+                l.segment_length = 262144;
+            }
+            l.segment_length_mask = l.segment_length - 1;
+
+            double const size_factor = size <= 1 ? 0 : std::max(1.125, 0.875 + 0.25 * ln(1000000) / ln(size));
+            auto const capacity = size <= 1 ? 0 : std::uint32_t(size * size_factor + 0.5);
+            // unsigned wraparound is intended here, as in the reference
+            std::uint32_t const init_segment_count =
+                (capacity + l.segment_length - 1) / l.segment_length - (arity - 1);
+            std::uint32_t array_length = (init_segment_count + arity - 1) * l.segment_length;
+            std::uint32_t segment_count = (array_length + l.segment_length - 1) / l.segment_length;
+            segment_count = segment_count <= arity - 1 ? 1 : segment_count - (arity - 1);
+            l.array_length = (segment_count + arity - 1) * l.segment_length;
+            l.segment_count_length = segment_count * l.segment_length;
+            return l;
+        }
+
+        struct filter {
+            layout geometry;
+            std::span<std::uint8_t const> fingerprints;
+            bool built;
+        };
+
+        constexpr auto contains(filter const& f, std::uint64_t key) -> bool {
+            std::uint64_t const hash = murmur64(key + f.geometry.seed);
+            auto const [h0, h1, h2] = positions(f.geometry, hash);
+            return (fingerprint(hash)
+                ^ f.fingerprints[h0]
+                ^ f.fingerprints[h1]
+                ^ f.fingerprints[h2]) == 0;
+        }
+
+        // Peels the 3-hypergraph of hashes onto slots (every step removes a
+        // slot that only one remaining hash maps to), and then assigns the
+        // fingerprints in the reverse order, so that each hash's three slots
+        // xor to its fingerprint. Retries with a new seed until peeling succeeds.
+        consteval auto build(std::span<std::uint64_t const> keys, std::vector<std::uint8_t>& fingerprints) -> layout {
+            layout l = make_layout(std::uint32_t(keys.size()));
+            std::uint64_t rng = 0x726b2b9d438b9d4d;
+
+            for (int attempt = 0; attempt != 100; ++attempt) {
+                // splitmix64
+                rng += 0x9e3779b97f4a7c15;
+                l.seed = murmur64(rng);
+
+                std::vector<std::uint64_t> hashes;
+                for (std::uint64_t k : keys) {
+                    hashes.push_back(murmur64(k + l.seed));
+                }
+                // equal hashes (from equal keys) cannot be peeled, and only
+                // need to be stored once anyway
+                std::ranges::sort(hashes);
+                hashes.erase(std::ranges::unique(hashes).begin(), hashes.end());
+
+                // for every slot: 4 * the number of hashes that map to it, plus
+                // the xor of which of their positions it is; and the xor of them
+                std::vector<std::uint32_t> count(l.array_length, 0);
+                std::vector<std::uint64_t> xors(l.array_length, 0);
+                for (std::uint64_t hash : hashes) {
+                    auto const h = positions(l, hash);
+                    for (std::uint32_t j = 0; j != 3; ++j) {
+                        count[h[j]] = (count[h[j]] + 4) ^ j;
+                        xors[h[j]] ^= hash;
+                    }
+                }
+
+                std::vector<std::uint32_t> alone;
+                for (std::uint32_t i = 0; i != l.array_length; ++i) {
+                    if (count[i] >> 2 == 1) {
+                        alone.push_back(i);
+                    }
+                }
+
+                std::vector<std::uint64_t> order;
+                std::vector<std::uint8_t> order_position;
+                while (not alone.empty()) {
+                    std::uint32_t const index = alone.back();
+                    alone.pop_back();
+                    if (count[index] >> 2 != 1) {
+                        continue;
+                    }
+                    std::uint64_t const hash = xors[index];
+                    std::uint32_t const found = count[index] & 3;
+                    order.push_back(hash);
+                    order_position.push_back(std::uint8_t(found));
+
+                    auto const h = positions(l, hash);
+                    for (std::uint32_t j = 0; j != 3; ++j) {
+                        count[h[j]] = (count[h[j]] - 4) ^ j;
+                        xors[h[j]] ^= hash;
+                        if (j != found and count[h[j]] >> 2 == 1) {
+                            alone.push_back(h[j]);
+                        }
+                    }
+                }
+                if (order.size() != hashes.size()) {
+                    continue;
+                }
+
+                fingerprints.assign(l.array_length, 0);
+                for (std::size_t i = order.size(); i-- != 0; ) {
+                    std::uint64_t const hash = order[i];
+                    auto const h = positions(l, hash);
+                    std::uint32_t const found = order_position[i];
+                    fingerprints[h[found]] = fingerprint(hash)
+                        ^ fingerprints[h[(found + 1) % 3]]
+                        ^ fingerprints[h[(found + 2) % 3]];
+                }
+                return l;
+            }
+
+            fingerprints.clear();
+            return l;
+        }
+
+        // The 64-bit value that a key is hashed from
+        template <class K>
+        constexpr auto key_hash(K const& key) -> std::uint64_t {
+            if constexpr (std::is_enum_v<K>) {
+                return static_cast<std::uint64_t>(std::to_underlying(key));
+            } else if constexpr (std::is_integral_v<K>) {
+                return static_cast<std::uint64_t>(key);
+            } else {
+                static_assert(std::convertible_to<K const&, std::string_view>,
+                              "ctp::fuse_filter keys must be integers, enums, or strings");
+                // FNV-1a
+                std::uint64_t h = 0xcbf29ce484222325;
+                for (char c : std::string_view(key)) {
+                    h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+                }
+                return h;
+            }
+        }
+
+        template <class K>
+        consteval auto make(std::span<K const> keys) -> filter {
+            std::vector<std::uint64_t> hashes;
+            for (K const& k : keys) {
+                hashes.push_back(key_hash(k));
+            }
+            std::vector<std::uint8_t> fingerprints;
+            layout const geometry = build(hashes, fingerprints);
+            if (fingerprints.empty()) {
+                return {.geometry = geometry, .fingerprints = {}, .built = false};
+            }
+            std::meta::info const array = std::meta::reflect_constant_array(fingerprints);
+            return {
+                .geometry = geometry,
+                .fingerprints = std::span(extract<std::uint8_t const*>(array), fingerprints.size()),
+                .built = true,
+            };
+        }
+    }
+}
+
+// An approximate set of the keys in Keys (a ctp::Param of a vector of integers,
+// enums, or strings), built at compile time. contains() never returns false for
+// one of the keys, which is checked at compile time, and returns true for any
+// other value with probability about 1/256. It costs about 9 bits per key for a
+// million keys or more, and about 11 for a few thousand, and every query reads
+// three bytes.
+//
+//      using deny_list = ctp::fuse_filter<load_deny_list()>;
+//      if (deny_list::contains(id) and exact_lookup(id)) { ... }
+template <Param Keys>
+    requires std::ranges::random_access_range<typename decltype(Keys)::type>
+class fuse_filter {
+public:
+    using key_type = decltype(Keys)::type::value_type;
+
+private:
+    static constexpr impl::fuse::filter state = impl::fuse::make(std::span<key_type const>(*Keys));
+    static_assert(state.built, "could not build a ctp::fuse_filter for these keys");
+    static_assert(std::ranges::all_of(*Keys, [](key_type const& k) {
+                      return impl::fuse::contains(state, impl::fuse::key_hash(k));
+                  }),
+                  "ctp::fuse_filter has a false negative");
+
+public:
+    static constexpr auto contains(key_type const& key) -> bool {
+        return impl::fuse::contains(state, impl::fuse::key_hash(key));
+    }
+
+    // The number of keys the filter was built from
+    static constexpr auto size() -> std::size_t { return Keys->size(); }
+
+    // The size of the fingerprint array
+    static constexpr auto size_in_bytes() -> std::size_t { return state.fingerprints.size(); }
+
+    static constexpr auto bits_per_key() -> double {
+        return Keys->empty() ? 0 : 8.0 * size_in_bytes() / Keys->size();
+    }
+};
+
+}
+
 #endif
 
 #endif
@@ -0,0 +1,34 @@
+#ifndef CTP_DLOPEN_TEST_ADDRESSES_HH
+#define CTP_DLOPEN_TEST_ADDRESSES_HH
+
+#define CTP_SHARED_IDENTITY
+#include <ctp/ctp.hh>
+
+// The addresses of a few ctp objects, as seen from whichever module this is
+// compiled into
+struct addresses {
+    void const* string;
+    void const* vector;
+    void const* optional;
+    void const* param;
+    void const* array;
+    void const* scalar;
+};
+
+template <ctp::Param V>
+auto address_of() -> void const* {
+    return &V.value;
+}
+
+inline auto local_addresses() -> addresses {
+    return {
+        .string = &ctp::define_static_object(std::string("hello")),
+        .vector = ctp::define_static_object(std::vector{1, 2, 3}).data(),
+        .optional = &ctp::define_static_object(std::optional<std::string>("world")),
+        .param = address_of<std::tuple<int, std::string>(1, "one")>(),
+        .array = &ctp::define_static_object(std::array{1, 2, 3}),
+        .scalar = &ctp::define_static_object(42),
+    };
+}
+
+#endif
@@ -0,0 +1,40 @@
+// Loads two plugins built from the same source, and checks that every ctp
+// object they use has the same address as in the executable.
+#include "addresses.hh"
+
+#include <dlfcn.h>
+#include <cstdio>
+
+namespace {
+
+auto check(char const* name, addresses const& expected, addresses const& actual) -> bool {
+    bool const same = expected.string == actual.string
+        and expected.vector == actual.vector
+        and expected.optional == actual.optional
+        and expected.param == actual.param
+        and expected.array == actual.array
+        and expected.scalar == actual.scalar;
+    std::printf("%s: %s\n", name, same ? "same addresses" : "DIFFERENT addresses");
+    return same;
+}
+
+}
+
+int main(int argc, char** argv) {
+    addresses const mine = local_addresses();
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        void* handle = dlopen(argv[i], RTLD_NOW | RTLD_LOCAL);
+        if (not handle) {
+            std::printf("%s: %s\n", argv[i], dlerror());
+            return 1;
+        }
+        auto get = reinterpret_cast<addresses (*)()>(dlsym(handle, "plugin_addresses"));
+        if (not get) {
+            std::printf("%s: %s\n", argv[i], dlerror());
+            return 1;
+        }
+        ok = check(argv[i], mine, get()) and ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,5 @@
+#include "addresses.hh"
+
+extern "C" [[gnu::visibility("default")]] auto plugin_addresses() -> addresses {
+    return local_addresses();
+}
@@ -0,0 +1,7 @@
+#include "greeting.hh"
+
+CTP_INSTANTIATE_PARAM(std::string, greeting, "hello");
+
+auto greeting_object() -> void const* {
+    return &ctp::define_static_object(std::string("hello"));
+}
@@ -0,0 +1,15 @@
+#ifndef CTP_EXTERN_TEST_GREETING_HH
+#define CTP_EXTERN_TEST_GREETING_HH
+
+#include <ctp/extern.hh>
+
+#include <string>
+
+// Only declared here: the object is evaluated and defined in greeting.cc
+CTP_EXTERN_PARAM(std::string, greeting);
+
+// The address of ctp::define_static_object(std::string("hello")), as seen from
+// greeting.cc
+auto greeting_object() -> void const*;
+
+#endif
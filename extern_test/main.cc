@@ -0,0 +1,15 @@
+// Uses the object declared by CTP_EXTERN_PARAM in another translation unit,
+// and checks that it links to the one that CTP_INSTANTIATE_PARAM defined.
+#include "greeting.hh"
+
+#include <cstdio>
+#include <string_view>
+
+int main() {
+    bool const same = &greeting == greeting_object();
+    bool const value = greeting == std::string_view("hello");
+    std::printf("greeting: %s, %s\n",
+                same ? "same address" : "DIFFERENT address",
+                value ? "expected value" : "WRONG value");
+    return same and value ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+#ifndef CTP_BITMASK_HH
+#define CTP_BITMASK_HH
+
+#include <ctp/core.hh>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ctp {
+
+// A fixed-width set of bits, with all of its state in public members so that it
+// is a structural type. This is the target of std::bitset<N>, and the storage of
+// ctp::enum_set. Equal masks compare equal as template arguments no matter how
+// they were built.
+template <std::size_t N>
+struct bitmask {
+    static constexpr std::size_t word_bits = 64;
+    // always at least one word, since std::array<T, 0> need not be structural
+    static constexpr std::size_t word_count = N == 0 ? 1 : (N + word_bits - 1) / word_bits;
+
+    std::array<std::uint64_t, word_count> words = {};
+
+    static constexpr auto size() -> std::size_t { return N; }
+
+    constexpr auto test(std::size_t i) const -> bool {
+        return (words[i / word_bits] >> (i % word_bits)) & 1;
+    }
+    constexpr auto set(std::size_t i, bool value = true) -> bitmask& {
+        std::uint64_t const bit = std::uint64_t(1) << (i % word_bits);
+        words[i / word_bits] = (words[i / word_bits] & ~bit) | (value ? bit : 0);
+        return *this;
+    }
+    constexpr auto reset(std::size_t i) -> bitmask& { return set(i, false); }
+
+    constexpr auto count() const -> std::size_t {
+        std::size_t n = 0;
+        for (std::uint64_t w : words) {
+            n += std::popcount(w);
+        }
+        return n;
+    }
+    constexpr auto any() const -> bool { return *this != bitmask(); }
+    constexpr auto none() const -> bool { return not any(); }
+    constexpr auto all() const -> bool { return count() == N; }
+
+    // Every bit of *this is also set in other
+    constexpr auto is_subset_of(bitmask const& other) const -> bool {
+        return (*this & other) == *this;
+    }
+
+    constexpr auto operator&=(bitmask const& rhs) -> bitmask& {
+        for (std::size_t i = 0; i != word_count; ++i) {
+            words[i] &= rhs.words[i];
+        }
+        return *this;
+    }
+    constexpr auto operator|=(bitmask const& rhs) -> bitmask& {
+        for (std::size_t i = 0; i != word_count; ++i) {
+            words[i] |= rhs.words[i];
+        }
+        return *this;
+    }
+    constexpr auto operator^=(bitmask const& rhs) -> bitmask& {
+        for (std::size_t i = 0; i != word_count; ++i) {
+            words[i] ^= rhs.words[i];
+        }
+        return *this;
+    }
+
+    friend constexpr auto operator&(bitmask lhs, bitmask const& rhs) -> bitmask { return lhs &= rhs; }
+    friend constexpr auto operator|(bitmask lhs, bitmask const& rhs) -> bitmask { return lhs |= rhs; }
+    friend constexpr auto operator^(bitmask lhs, bitmask const& rhs) -> bitmask { return lhs ^= rhs; }
+
+    // Complement, keeping the bits past N clear so that equality stays meaningful
+    constexpr auto operator~() const -> bitmask {
+        bitmask r;
+        for (std::size_t i = 0; i != word_count; ++i) {
+            r.words[i] = ~words[i];
+        }
+        if constexpr (N % word_bits != 0) {
+            r.words[word_count - 1] &= (std::uint64_t(1) << (N % word_bits)) - 1;
+        } else if constexpr (N == 0) {
+            r.words[0] = 0;
+        }
+        return r;
+    }
+
+    constexpr auto operator==(bitmask const&) const -> bool = default;
+};
+
+namespace impl {
+    // A perfect hash from a fixed set of 64-bit keys to slots, found at compile
+    // time by hash-and-displace: a key's bucket is the high bits of its mixed
+    // hash, and its slot is the low bits xor-ed with a displacement chosen per
+    // bucket so that no two keys share a slot. Each slot records the key that
+    // owns it (if any) and that key's rank, so a lookup is one hash and three
+    // table reads, with no loops.
+    struct perfect_hash {
+        // false if no seed worked, in which case nothing else is meaningful
+        bool found;
+        std::uint64_t seed;
+        int bucket_bits;
+        std::uint64_t slot_mask;
+        std::span<std::uint64_t const> displacements;
+        std::span<std::uint64_t const> slot_keys;
+        std::span<std::uint32_t const> slot_ranks;
+    };
+
+    constexpr auto perfect_hash_mix(std::uint64_t key, std::uint64_t seed) -> std::uint64_t {
+        std::uint64_t h = key ^ seed;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return h;
+    }
+
+    constexpr auto perfect_hash_bucket(perfect_hash const& ph, std::uint64_t h) -> std::size_t {
+        return ph.bucket_bits == 0 ? 0 : std::size_t(h >> (64 - ph.bucket_bits));
+    }
+
+    constexpr auto perfect_hash_slot(perfect_hash const& ph, std::uint64_t key) -> std::size_t {
+        std::uint64_t const h = perfect_hash_mix(key, ph.seed);
+        return std::size_t((h ^ ph.displacements[perfect_hash_bucket(ph, h)]) & ph.slot_mask);
+    }
+
+    // The rank of key in the keys the hash was built from, or missing if it is
+    // not one of them
+    constexpr auto perfect_hash_find(perfect_hash const& ph, std::uint64_t key, std::size_t missing) -> std::size_t {
+        std::size_t const slot = perfect_hash_slot(ph, key);
+        return ph.slot_keys[slot] == key ? ph.slot_ranks[slot] : missing;
+    }
+
+    // keys must be distinct; key i gets rank i
+    consteval auto make_perfect_hash(std::span<std::uint64_t const> keys) -> perfect_hash {
+        std::size_t const n = keys.size();
+        std::size_t const slots = std::bit_ceil(2 * n);
+        int const bucket_bits = std::bit_width(std::bit_ceil(std::max<std::size_t>(n / 4, 1))) - 1;
+        std::size_t const buckets = std::size_t(1) << bucket_bits;
+
+        perfect_hash ph = {.found = false, .bucket_bits = bucket_bits, .slot_mask = slots - 1};
+        std::uint64_t rng = 0x2545f4914f6cdd1d;
+        for (int attempt = 0; attempt != 256; ++attempt) {
+            // splitmix64
+            rng += 0x9e3779b97f4a7c15;
+            ph.seed = perfect_hash_mix(rng, 0);
+
+            std::vector<std::vector<std::size_t>> by_bucket(buckets);
+            for (std::size_t i = 0; i != n; ++i) {
+                by_bucket[perfect_hash_bucket(ph, perfect_hash_mix(keys[i], ph.seed))].push_back(i);
+            }
+            std::vector<std::size_t> order(buckets);
+            for (std::size_t b = 0; b != buckets; ++b) {
+                order[b] = b;
+            }
+            // the biggest buckets are the hardest to place, so they go first
+            std::ranges::stable_sort(order, std::ranges::greater(),
+                                     [&](std::size_t b) { return by_bucket[b].size(); });
+
+            std::vector<std::uint64_t> displacements(buckets, 0);
+            std::vector<std::uint64_t> slot_keys(slots, 0);
+            // an empty slot has rank n, which is a miss whatever key it has
+            std::vector<std::uint32_t> slot_ranks(slots, std::uint32_t(n));
+            std::vector<bool> used(slots, false);
+            bool placed_all = true;
+            for (std::size_t b : order) {
+                bool placed = by_bucket[b].empty();
+                for (std::uint64_t d = 0; d != slots and not placed; ++d) {
+                    std::vector<std::size_t> taken;
+                    for (std::size_t i : by_bucket[b]) {
+                        std::size_t const slot = (perfect_hash_mix(keys[i], ph.seed) ^ d) & ph.slot_mask;
+                        if (used[slot] or std::ranges::contains(taken, slot)) {
+                            break;
+                        }
+                        taken.push_back(slot);
+                    }
+                    if (taken.size() != by_bucket[b].size()) {
+                        continue;
+                    }
+                    displacements[b] = d;
+                    for (std::size_t j = 0; j != taken.size(); ++j) {
+                        used[taken[j]] = true;
+                        slot_keys[taken[j]] = keys[by_bucket[b][j]];
+                        slot_ranks[taken[j]] = std::uint32_t(by_bucket[b][j]);
+                    }
+                    placed = true;
+                }
+                if (not placed) {
+                    placed_all = false;
+                    break;
+                }
+            }
+            if (not placed_all) {
+                continue;
+            }
+
+            ph.displacements = std::define_static_array(displacements);
+            ph.slot_keys = std::define_static_array(slot_keys);
+            ph.slot_ranks = std::define_static_array(slot_ranks);
+            ph.found = true;
+            return ph;
+        }
+        return {};
+    }
+
+    // The unsigned type in which distances between values of E are computed.
+    // bool has no make_unsigned_t, but is already unsigned.
+    template <class E>
+    using enum_unsigned_t = [: std::same_as<std::underlying_type_t<E>, bool>
+                               ? ^^unsigned char
+                               : substitute(^^std::make_unsigned_t, {^^std::underlying_type_t<E>}) :];
+
+    // The distance from lo up to e, which fits in the unsigned type even when
+    // e - lo does not fit in the underlying one. The result is converted back
+    // to the unsigned type, since a narrower one is promoted to int by the
+    // subtraction.
+    template <class E>
+    constexpr auto enum_offset(E e, E lo) -> std::size_t {
+        using K = enum_unsigned_t<E>;
+        return std::size_t(K(K(e) - K(lo)));
+    }
+
+    // The domain of an enum_set: the distinct enumerator values of E, sorted.
+    // When they span a small enough range, the bit for a value is just its
+    // distance from the smallest one (and the bits for values in between that
+    // are not enumerators are never set); otherwise it is its rank in values,
+    // found through a perfect hash.
+    template <class E>
+    struct enum_domain {
+        std::span<E const> values;
+        E min;
+        bool dense;
+        std::size_t width;
+        perfect_hash hash;
+    };
+
+    inline constexpr std::size_t max_dense_enum_width = 1024;
+
+    template <class E>
+    consteval auto make_enum_domain() -> enum_domain<E> {
+        using U = std::underlying_type_t<E>;
+        std::vector<E> values;
+        for (std::meta::info e : enumerators_of(^^E)) {
+            values.push_back(extract<E>(e));
+        }
+        std::ranges::sort(values, {}, [](E e) { return U(e); });
+        values.erase(std::ranges::unique(values).begin(), values.end());
+
+        if (values.empty()) {
+            return {.values = {}, .min = E(), .dense = true, .width = 0, .hash = {}};
+        }
+        E const lo = values.front();
+        std::size_t const range = enum_offset(values.back(), lo);
+        if (range < max_dense_enum_width) {
+            return {
+                .values = std::define_static_array(values),
+                .min = lo,
+                .dense = true,
+                .width = range + 1,
+                .hash = {},
+            };
+        }
+
+        std::vector<std::uint64_t> keys;
+        for (E e : values) {
+            keys.push_back(std::uint64_t(U(e)));
+        }
+        return {
+            .values = std::define_static_array(values),
+            .min = lo,
+            .dense = false,
+            .width = values.size(),
+            .hash = make_perfect_hash(keys),
+        };
+    }
+}
+
+namespace impl {
+    template <class E, std::size_t Width>
+    consteval auto enum_valid_bits(enum_domain<E> const& domain) -> bitmask<Width> {
+        bitmask<Width> m;
+        for (std::size_t i = 0; i != domain.values.size(); ++i) {
+            m.set(domain.dense ? enum_offset(domain.values[i], domain.min) : i);
+        }
+        return m;
+    }
+}
+
+// A set of enumerators of E, stored as a bitmask, which makes this a structural
+// type (and the target of std::set<E>). When the enumerators span at most 1024
+// values, there is a bit for every value in that range, and the bit for a value
+// is found with a subtraction; otherwise there is one bit per enumerator, found
+// through a perfect hash. Either way, contains() is constant time, without
+// loops, and rejects anything that is not an enumerator of E.
+template <class E>
+    requires std::is_enum_v<E>
+struct enum_set {
+    static constexpr impl::enum_domain<E> domain = impl::make_enum_domain<E>();
+    static_assert(domain.dense or domain.hash.found,
+                  "could not find a perfect hash for the enumerators of E");
+    using mask_type = bitmask<domain.width>;
+
+    mask_type bits = {};
+
+    constexpr enum_set() = default;
+    constexpr enum_set(std::initializer_list<E> es) {
+        for (E e : es) {
+            insert(e);
+        }
+    }
+
+    // The number of possible members, which is the width of the mask
+    static constexpr auto capacity() -> std::size_t { return domain.width; }
+
+    // The bits that belong to enumerators, which in the dense case are not
+    // necessarily all of them
+    static constexpr mask_type valid = impl::enum_valid_bits<E, domain.width>(domain);
+
+    // The bit position for e, or capacity() if e is not an enumerator of E
+    static constexpr auto index_of(E e) -> std::size_t {
+        using U = std::underlying_type_t<E>;
+        if constexpr (domain.dense) {
+            std::size_t const i = impl::enum_offset(e, domain.min);
+            return i < domain.width and valid.test(i) ? i : domain.width;
+        } else {
+            return impl::perfect_hash_find(domain.hash, std::uint64_t(U(e)), domain.width);
+        }
+    }
+
+    constexpr auto contains(E e) const -> bool {
+        std::size_t const i = index_of(e);
+        return i != domain.width && bits.test(i);
+    }
+    constexpr auto insert(E e) -> enum_set& {
+        if (std::size_t const i = index_of(e); i != domain.width) {
+            bits.set(i);
+        }
+        return *this;
+    }
+    constexpr auto erase(E e) -> enum_set& {
+        if (std::size_t const i = index_of(e); i != domain.width) {
+            bits.reset(i);
+        }
+        return *this;
+    }
+
+    constexpr auto size() const -> std::size_t { return bits.count(); }
+    constexpr auto empty() const -> bool { return bits.none(); }
+    constexpr auto is_subset_of(enum_set const& other) const -> bool {
+        return bits.is_subset_of(other.bits);
+    }
+
+    friend constexpr auto operator&(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits &= rhs.bits;
+        return lhs;
+    }
+    friend constexpr auto operator|(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits |= rhs.bits;
+        return lhs;
+    }
+    friend constexpr auto operator^(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits ^= rhs.bits;
+        return lhs;
+    }
+    // Set difference
+    friend constexpr auto operator-(enum_set lhs, enum_set const& rhs) -> enum_set {
+        lhs.bits &= ~rhs.bits;
+        return lhs;
+    }
+
+    constexpr auto operator==(enum_set const&) const -> bool = default;
+};
+
+}
+
+#endif
\ No newline at end of file
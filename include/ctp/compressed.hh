@@ -0,0 +1,325 @@
+#ifndef CTP_COMPRESSED_HH
+#define CTP_COMPRESSED_HH
+
+#include <ctp/core.hh>
+#include <ctp/param.hh>
+#include <ctp/custom.hh>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace ctp {
+
+// How hard ctp::compressed should work at compile time. Every level other than
+// none produces the same format, so decoding speed only depends on the amount
+// of data: higher levels follow longer match chains and give smaller images in
+// exchange for more constant evaluation. none stores the bytes as-is, for when
+// access latency matters more than binary size.
+enum class compression {
+    none,
+    fast,
+    balanced,
+    best,
+};
+
+namespace impl {
+    // The result of compressing at compile time. Block i of the original data
+    // is stored in bytes[offsets[i]:offsets[i+1]], and every block is encoded
+    // independently so that it can be decompressed on its own.
+    struct compressed_image {
+        std::span<std::byte const> bytes;
+        std::span<std::size_t const> offsets;
+        std::size_t size;
+    };
+
+    // A small LZ77 codec, in the style of LZ4. Each sequence is a token byte
+    // (high nibble: literal count, low nibble: match length - 4, 15 meaning
+    // that more length bytes follow), the literals, and then a two byte
+    // little-endian distance followed by any extra match length bytes. The
+    // last sequence of a block has only literals.
+    namespace lz {
+        inline constexpr std::size_t min_match = 4;
+        inline constexpr std::size_t max_distance = 65535;
+        inline constexpr int hash_bits = 14;
+
+        consteval auto chain_depth(compression level) -> int {
+            switch (level) {
+            case compression::none:     return 0;
+            case compression::fast:     return 1;
+            case compression::balanced: return 16;
+            case compression::best:     return 256;
+            }
+            return 0;
+        }
+
+        consteval auto hash(std::span<std::byte const> in, std::size_t i) -> std::size_t {
+            std::uint32_t v = std::to_integer<std::uint32_t>(in[i])
+                | std::to_integer<std::uint32_t>(in[i + 1]) << 8
+                | std::to_integer<std::uint32_t>(in[i + 2]) << 16
+                | std::to_integer<std::uint32_t>(in[i + 3]) << 24;
+            return (v * 2654435761u) >> (32 - hash_bits);
+        }
+
+        consteval auto push_length(std::vector<std::byte>& out, std::size_t n) -> void {
+            while (n >= 255) {
+                out.push_back(std::byte(255));
+                n -= 255;
+            }
+            out.push_back(std::byte(n));
+        }
+
+        consteval auto push_sequence(std::vector<std::byte>& out,
+                                     std::span<std::byte const> literals,
+                                     std::size_t distance,
+                                     std::size_t length) -> void {
+            std::size_t const lit = literals.size();
+            std::size_t const extra = length == 0 ? 0 : length - min_match;
+            out.push_back(std::byte((lit < 15 ? lit : 15) << 4 | (extra < 15 ? extra : 15)));
+            if (lit >= 15) {
+                push_length(out, lit - 15);
+            }
+            out.insert(out.end(), literals.begin(), literals.end());
+            if (length == 0) {
+                return;
+            }
+            out.push_back(std::byte(distance & 0xff));
+            out.push_back(std::byte(distance >> 8));
+            if (extra >= 15) {
+                push_length(out, extra - 15);
+            }
+        }
+
+        consteval auto encode_block(std::vector<std::byte>& out,
+                                    std::span<std::byte const> in,
+                                    compression level) -> void {
+            std::size_t const n = in.size();
+            int const depth = chain_depth(level);
+            std::vector<std::ptrdiff_t> head(std::size_t(1) << hash_bits, -1);
+            std::vector<std::ptrdiff_t> prev(n, -1);
+
+            auto insert = [&](std::size_t i) {
+                std::size_t const h = hash(in, i);
+                prev[i] = head[h];
+                head[h] = std::ptrdiff_t(i);
+            };
+
+            std::size_t anchor = 0;
+            std::size_t i = 0;
+            while (i + min_match <= n) {
+                std::size_t best_length = 0;
+                std::size_t best_distance = 0;
+                std::ptrdiff_t candidate = head[hash(in, i)];
+                for (int d = 0; d < depth && candidate >= 0; ++d) {
+                    std::size_t const c = std::size_t(candidate);
+                    if (i - c > max_distance) {
+                        break;
+                    }
+                    std::size_t length = 0;
+                    while (i + length < n && in[c + length] == in[i + length]) {
+                        ++length;
+                    }
+                    if (length > best_length) {
+                        best_length = length;
+                        best_distance = i - c;
+                    }
+                    candidate = prev[c];
+                }
+
+                insert(i);
+                if (best_length < min_match) {
+                    ++i;
+                    continue;
+                }
+
+                push_sequence(out, in.subspan(anchor, i - anchor), best_distance, best_length);
+                std::size_t const end = i + best_length;
+                // fast skips indexing the interior of matches, which is most of
+                // the compile-time cost on repetitive data
+                if (level != compression::fast) {
+                    for (++i; i < end && i + min_match <= n; ++i) {
+                        insert(i);
+                    }
+                }
+                i = end;
+                anchor = end;
+            }
+            push_sequence(out, in.subspan(anchor), 0, 0);
+        }
+
+        constexpr auto read_length(std::byte const*& in, std::size_t n) -> std::size_t {
+            if (n == 15) {
+                std::size_t b;
+                do {
+                    b = std::to_integer<std::size_t>(*in++);
+                    n += b;
+                } while (b == 255);
+            }
+            return n;
+        }
+
+        // Decodes one block, which must decompress to exactly out.size() bytes
+        constexpr auto decode_block(std::byte const* in, std::span<std::byte> out) -> void {
+            std::byte* o = out.data();
+            std::byte* const end = o + out.size();
+            for (;;) {
+                unsigned const token = std::to_integer<unsigned>(*in++);
+                std::size_t const lit = read_length(in, token >> 4);
+                for (std::size_t k = 0; k != lit; ++k) {
+                    *o++ = *in++;
+                }
+                if (o == end) {
+                    return;
+                }
+
+                std::size_t const distance = std::to_integer<std::size_t>(in[0])
+                    | std::to_integer<std::size_t>(in[1]) << 8;
+                in += 2;
+                std::size_t const length = read_length(in, token & 15) + min_match;
+                // byte at a time, since the source may overlap the destination
+                std::byte const* m = o - distance;
+                for (std::size_t k = 0; k != length; ++k) {
+                    *o++ = *m++;
+                }
+            }
+        }
+    }
+
+    consteval auto compress(std::span<std::byte const> data,
+                            compression level,
+                            std::size_t block_size) -> compressed_image {
+        std::vector<std::byte> bytes;
+        std::vector<std::size_t> offsets = {0};
+        for (std::size_t i = 0; i < data.size(); i += block_size) {
+            auto block = data.subspan(i, std::min(block_size, data.size() - i));
+            if (level == compression::none) {
+                bytes.insert(bytes.end(), block.begin(), block.end());
+            } else {
+                lz::encode_block(bytes, block, level);
+            }
+            offsets.push_back(bytes.size());
+        }
+        return compressed_image{
+            .bytes = std::define_static_array(bytes),
+            .offsets = std::define_static_array(offsets),
+            .size = data.size(),
+        };
+    }
+}
+
+// Embedded binary data, compressed at compile time.
+//
+// Only the compressed image is emitted into the binary (as long as Data itself
+// is not odr-used). The original bytes are available either through data(),
+// which decompresses everything once, on first use, into a zero-initialized
+// static buffer, or block by block through chunks().
+//
+// BlockSize is the granularity of chunks(): smaller blocks mean less memory
+// and latency per chunk, larger blocks give the compressor more history to
+// find matches in.
+template <Param<std::vector<std::byte>> Data,
+          compression Level = compression::balanced,
+          std::size_t BlockSize = 64 * 1024>
+    requires (BlockSize > 0)
+class compressed {
+    static constexpr impl::compressed_image image = impl::compress(*Data, Level, BlockSize);
+
+public:
+    static constexpr compression level = Level;
+    static constexpr std::size_t block_size = BlockSize;
+
+    // The size of the original data
+    static constexpr auto size() -> std::size_t { return image.size; }
+
+    // The size of the embedded compressed image
+    static constexpr auto compressed_size() -> std::size_t { return image.bytes.size(); }
+
+    static constexpr auto block_count() -> std::size_t { return image.offsets.size() - 1; }
+
+    // The compressed image, e.g. for writing out as-is
+    static constexpr auto compressed_bytes() -> std::span<std::byte const> { return image.bytes; }
+
+    // Decompresses block i into out, which must be at least BlockSize bytes, and
+    // returns the part of out that was written.
+    static constexpr auto decompress_block(std::size_t i, std::span<std::byte> out) -> std::span<std::byte> {
+        std::size_t const n = std::min(BlockSize, size() - i * BlockSize);
+        out = out.first(n);
+        std::byte const* in = image.bytes.data() + image.offsets[i];
+        if constexpr (Level == compression::none) {
+            std::copy_n(in, n, out.data());
+        } else {
+            impl::lz::decode_block(in, out);
+        }
+        return out;
+    }
+
+    // Decompresses everything into out, which must be at least size() bytes
+    static constexpr auto decompress(std::span<std::byte> out) -> void {
+        for (std::size_t i = 0; i != block_count(); ++i) {
+            decompress_block(i, out.subspan(i * BlockSize));
+        }
+    }
+
+    // The original data. The first call decompresses it; concurrent first calls
+    // are safe, and every call returns the same buffer.
+    static auto data() -> std::span<std::byte const> {
+        static std::array<std::byte, size()> const& buffer = []() -> auto& {
+            static std::array<std::byte, size()> storage;
+            decompress(storage);
+            return storage;
+        }();
+        return buffer;
+    }
+
+    // An input range over the decompressed blocks, in order. Each chunk is only
+    // valid until the iterator is incremented.
+    class chunk_range {
+        std::vector<std::byte> buffer = std::vector<std::byte>(std::min(BlockSize, size()));
+
+    public:
+        class iterator {
+            chunk_range* range = nullptr;
+            std::size_t block = 0;
+            std::span<std::byte const> chunk;
+
+            auto load() -> void {
+                if (block != block_count()) {
+                    chunk = decompress_block(block, range->buffer);
+                }
+            }
+
+        public:
+            using value_type = std::span<std::byte const>;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::input_iterator_tag;
+
+            iterator() = default;
+            explicit iterator(chunk_range* r) : range(r) { load(); }
+
+            auto operator*() const -> value_type { return chunk; }
+            auto operator++() -> iterator& {
+                ++block;
+                load();
+                return *this;
+            }
+            auto operator++(int) -> void { ++*this; }
+
+            friend auto operator==(iterator const& it, std::default_sentinel_t) -> bool {
+                return it.block == block_count();
+            }
+        };
+
+        auto begin() -> iterator { return iterator(this); }
+        auto end() const -> std::default_sentinel_t { return std::default_sentinel; }
+    };
+
+    static auto chunks() -> chunk_range { return {}; }
+};
+
+}
+
+#endif
\ No newline at end of file
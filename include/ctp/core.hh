@@ -48,11 +48,31 @@ template <class T>
 using target_or_ref = [: is_lvalue_reference_type(^^T) ? ^^T : substitute(^^target, {^^T}) :];
 
 
+// Opt-in: with CTP_SHARED_IDENTITY defined (consistently, in every TU of every
+// module), the objects that ctp creates get default visibility even under
+// -fvisibility=hidden. Being inline variables, they are then merged by the
+// dynamic linker, so that a given value has one address across the executable
+// and any dlopen()-ed plugins, and can be compared by address alone. This
+// requires that the first module to define an object is visible to the others:
+// link the executable with -rdynamic (or load plugins with RTLD_GLOBAL), and do
+// not link plugins with -Bsymbolic. See dlopen_test/ for a checked example.
+//
+// This covers every object returned by ctp::define_static_object (and so the
+// value of a ctp::Param of a non-structural type), but not template parameter
+// objects that ctp does not create: the value of a ctp::Param of a structural
+// type lives in the Param itself, and has the visibility the compiler gives it.
+// Use ctp::define_static_object(*V) where such an object needs one address.
+#ifdef CTP_SHARED_IDENTITY
+#define CTP_OBJECT_VISIBILITY [[gnu::visibility("default")]]
+#else
+#define CTP_OBJECT_VISIBILITY
+#endif
+
 namespace impl {
     // This is the singular (private) object that will be
     // constructed from the serialization-deserialization round trip.
     template <class T, std::meta::info... Is>
-    inline constexpr target<T> the_object = []{
+    CTP_OBJECT_VISIBILITY inline constexpr target<T> the_object = []{
         if constexpr (requires { Reflect<T>::template deserialize<Is...>(); }) {
             return Reflect<T>::template deserialize<Is...>();
         } else if constexpr (requires { Reflect<T>::deserialize(Is...); }) {
@@ -62,9 +82,15 @@ namespace impl {
         }
     }();
 
+    // With CTP_SHARED_IDENTITY, the object that ctp::define_static_object returns
+    // for a structural type, in place of a template parameter object (whose
+    // visibility ctp cannot control)
+    template <class T, T V>
+    CTP_OBJECT_VISIBILITY inline constexpr T the_value = V;
+
     // This is the singular (private) object that will be used for reflect_constant_array
     template <class T, std::meta::info... Is>
-    inline constexpr target<T> the_array[] = {[:Is:]...};
+    CTP_OBJECT_VISIBILITY inline constexpr target<T> the_array[] = {[:Is:]...};
 
     // The default/simple approach to serialization, using Serializer
     template <class T>
@@ -111,6 +137,11 @@ inline constexpr auto reflect_constant_array =
 // Extension of std::define_static_object, except based on ctp::reflect_constant
 inline constexpr auto define_static_object =
     []<class T>(T const& v) -> target<T> const& {
+        #ifdef CTP_SHARED_IDENTITY
+        if constexpr (is_structural_type(^^T)) {
+            return extract<T const&>(substitute(^^impl::the_value, {^^T, reflect_constant(v)}));
+        } else
+        #endif
         // ctp::reflect_constant gives us a reflection representing an object
         // UNLESS T is a scalar type, in which case we have to do something else
         if constexpr (is_class_type(^^T)) {
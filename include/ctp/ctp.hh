@@ -5,5 +5,11 @@
 #include <ctp/serialize.hh>
 #include <ctp/param.hh>
 #include <ctp/custom.hh>
+#include <ctp/extern.hh>
+#include <ctp/compressed.hh>
+#include <ctp/table.hh>
+#include <ctp/image.hh>
+#include <ctp/kernels.hh>
+#include <ctp/fuse_filter.hh>
 
 #endif
\ No newline at end of file
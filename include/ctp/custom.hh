@@ -3,6 +3,10 @@
 
 #include <ctp/core.hh>
 #include <ctp/serialize.hh>
+#include <ctp/bitmask.hh>
+
+#include <bitset>
+#include <set>
 
 namespace ctp {
     template <>
@@ -31,6 +35,59 @@ namespace ctp {
         }
     };
 
+    // A set is serialized like a vector of its (already sorted, unique) elements
+    template <class T>
+    struct Reflect<std::set<T>> {
+        using target_type = std::span<target<T> const>;
+
+        static consteval auto serialize(Serializer& s, std::set<T> const& v) -> void {
+            s.push(reflect_constant_array(v));
+        }
+
+        static consteval auto deserialize(std::meta::info r) -> std::span<target<T> const> {
+            return std::span(extract<target<T> const*>(r), extent(type_of(r)));
+        }
+    };
+
+    // ... except for a set of enumerators, which becomes a bitmask over the
+    // enumerators of E
+    template <class E> requires std::is_enum_v<E>
+    struct Reflect<std::set<E>> {
+        using target_type = enum_set<E>;
+
+        static consteval auto serialize(Serializer& s, std::set<E> const& v) -> void {
+            enum_set<E> m;
+            for (E e : v) {
+                if (enum_set<E>::index_of(e) == enum_set<E>::capacity()) {
+                    throw "ctp::enum_set can only hold enumerators of E";
+                }
+                m.insert(e);
+            }
+            s.push_constant(m);
+        }
+
+        static consteval auto deserialize_constants(enum_set<E> const& m) -> target_type {
+            return m;
+        }
+    };
+
+    template <size_t N>
+    struct Reflect<std::bitset<N>> {
+        using target_type = bitmask<N>;
+
+        static consteval auto serialize(Serializer& s, std::bitset<N> const& b) -> void {
+            bitmask<N> m;
+            for (size_t i = 0; i != N; ++i) {
+                m.set(i, b.test(i));
+            }
+            s.push_constant(m);
+        }
+
+        static consteval auto deserialize_constants(bitmask<N> const& m) -> target_type {
+            return m;
+        }
+    };
+
     template <class T>
     struct Reflect<std::optional<T>> {
         using target_type = std::optional<target<T>>;
@@ -63,17 +120,24 @@ namespace ctp {
 
     template <class... Ts>
     struct Reflect<std::variant<Ts...>> {
+        // this still needs target<Ts> for every alternative, but only once per
+        // variant type, not once per value
         using target_type = std::variant<target<Ts>...>;
 
+        template <size_t I>
+        static consteval auto serialize_alternative(Serializer& s, std::variant<Ts...> const& v) -> void {
+            s.push_constant(*std::get_if<I>(&v));
+        }
+
         static consteval auto serialize(Serializer& s, std::variant<Ts...> const& v) -> void {
             s.push_constant(v.index());
-            // visit should work, but can't because of LWG4197
-            template for (constexpr size_t I : std::views::iota(0zu, sizeof...(Ts))) {
-                if (I == v.index()) {
-                    s.push_constant(std::get<I>(v));
-                    return;
-                }
-            }
+            // Rather than scanning the alternatives for the active one (visit
+            // can't be used because of LWG4197), which costs linear time per
+            // value and instantiates push_constant for every alternative, splice
+            // in the serializer for just the active one
+            auto serialize_active = extract<void (*)(Serializer&, std::variant<Ts...> const&)>(
+                substitute(^^serialize_alternative, {std::meta::reflect_constant(v.index())}));
+            serialize_active(s, v);
         }
 
         template <std::meta::info I, std::meta::info R>
@@ -0,0 +1,32 @@
+#ifndef CTP_EXTERN_HH
+#define CTP_EXTERN_HH
+
+#include <ctp/core.hh>
+#include <ctp/serialize.hh>
+#include <ctp/custom.hh>
+
+// Building a large ctp object (serializing it, and then instantiating its
+// ctp::impl::the_object) happens in every translation unit that names it.
+// For objects that are only needed at runtime, these macros move all of that
+// work into one translation unit:
+//
+//      // tables.hh: every other TU only sees a declaration
+//      CTP_EXTERN_PARAM(std::vector<int>, primes);
+//
+//      // tables.cc: the one TU that evaluates and emits the object
+//      CTP_INSTANTIATE_PARAM(std::vector<int>, primes, compute_primes(100'000));
+//
+// Both declare a reference to target<T> named name, in the current namespace.
+// Outside of the instantiating TU it cannot be used in constant expressions,
+// since its value is not known there. It is constant-initialized, so there is
+// no static initialization order to worry about. The object is the same one that
+// ctp::define_static_object would return for the same value, so it keeps its
+// identity with any other use of that value. T cannot contain an unparenthesized
+// comma; use an alias for such types.
+#define CTP_EXTERN_PARAM(T, name) \
+    extern constinit ::ctp::target<T> const& name
+
+#define CTP_INSTANTIATE_PARAM(T, name, ...) \
+    constinit ::ctp::target<T> const& name = ::ctp::define_static_object(T(__VA_ARGS__))
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef CTP_FUSE_FILTER_HH
+#define CTP_FUSE_FILTER_HH
+
+#include <ctp/core.hh>
+#include <ctp/param.hh>
+#include <ctp/custom.hh>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctp {
+
+namespace impl {
+    namespace fuse {
+        // Binary fuse filters, from "Binary Fuse Filters: Fast and Smaller Than
+        // Xor Filters" (Graf and Lemire), with 8-bit fingerprints and 3 hashes
+        struct layout {
+            std::uint64_t seed;
+            std::uint32_t segment_length;
+            std::uint32_t segment_length_mask;
+            std::uint32_t segment_count_length;
+            std::uint32_t array_length;
+        };
+
+        constexpr auto murmur64(std::uint64_t h) -> std::uint64_t {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccd;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53;
+            h ^= h >> 33;
+            return h;
+        }
+
+        // The high 64 bits of a * b, from 32-bit halves, so as not to need a
+        // 128-bit integer type
+        constexpr auto mulhi(std::uint64_t a, std::uint64_t b) -> std::uint64_t {
+            std::uint64_t const a_lo = a & 0xffffffff;
+            std::uint64_t const a_hi = a >> 32;
+            std::uint64_t const b_lo = b & 0xffffffff;
+            std::uint64_t const b_hi = b >> 32;
+
+            std::uint64_t const lo_lo = a_lo * b_lo;
+            std::uint64_t const hi_lo = a_hi * b_lo;
+            std::uint64_t const lo_hi = a_lo * b_hi;
+            std::uint64_t const hi_hi = a_hi * b_hi;
+
+            // the middle column, with the carry out of the low 32 bits
+            std::uint64_t const middle = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+            return hi_hi + (hi_lo >> 32) + (middle >> 32);
+        }
+
+        constexpr auto fingerprint(std::uint64_t hash) -> std::uint8_t {
+            return static_cast<std::uint8_t>(hash ^ (hash >> 32));
+        }
+
+        constexpr auto positions(layout const& l, std::uint64_t hash) -> std::array<std::uint32_t, 3> {
+            std::uint64_t const h0 = mulhi(hash, l.segment_count_length);
+            std::uint64_t const h1 = (h0 + l.segment_length) ^ ((hash >> 18) & l.segment_length_mask);
+            std::uint64_t const h2 = (h0 + 2 * l.segment_length) ^ (hash & l.segment_length_mask);
+            return {std::uint32_t(h0), std::uint32_t(h1), std::uint32_t(h2)};
+        }
+
+        // The natural logarithm, since std::log is not usable at compile time
+        consteval auto ln(double x) -> double {
+            int e = 0;
+            for (; x >= 2; x /= 2) {
+                ++e;
+            }
+            for (; x < 1; x *= 2) {
+                --e;
+            }
+            double const y = (x - 1) / (x + 1);
+            double term = y;
+            double sum = 0;
+            for (int k = 1; k < 64; k += 2) {
+                sum += term / k;
+                term *= y * y;
+            }
+            return 2 * sum + e * 0.6931471805599453;
+        }
+
+        // The sizing from the reference implementation, which gives about 1.125
+        // slots per key for large key counts
+        consteval auto make_layout(std::uint32_t size) -> layout {
+            constexpr std::uint32_t arity = 3;
+            layout l = {};
+            l.segment_length = size == 0
+                ? 4
+                : std::uint32_t(1) << int(ln(size) / ln(3.33) + 2.25);
+            if (l.segment_length > 262144) {
+                l.segment_length = 262144;
+            }
+            l.segment_length_mask = l.segment_length - 1;
+
+            double const size_factor = size <= 1 ? 0 : std::max(1.125, 0.875 + 0.25 * ln(1000000) / ln(size));
+            auto const capacity = size <= 1 ? 0 : std::uint32_t(size * size_factor + 0.5);
+            // unsigned wraparound is intended here, as in the reference
+            std::uint32_t const init_segment_count =
+                (capacity + l.segment_length - 1) / l.segment_length - (arity - 1);
+            std::uint32_t array_length = (init_segment_count + arity - 1) * l.segment_length;
+            std::uint32_t segment_count = (array_length + l.segment_length - 1) / l.segment_length;
+            segment_count = segment_count <= arity - 1 ? 1 : segment_count - (arity - 1);
+            l.array_length = (segment_count + arity - 1) * l.segment_length;
+            l.segment_count_length = segment_count * l.segment_length;
+            return l;
+        }
+
+        struct filter {
+            layout geometry;
+            std::span<std::uint8_t const> fingerprints;
+            bool built;
+        };
+
+        constexpr auto contains(filter const& f, std::uint64_t key) -> bool {
+            std::uint64_t const hash = murmur64(key + f.geometry.seed);
+            auto const [h0, h1, h2] = positions(f.geometry, hash);
+            return (fingerprint(hash)
+                ^ f.fingerprints[h0]
+                ^ f.fingerprints[h1]
+                ^ f.fingerprints[h2]) == 0;
+        }
+
+        // Peels the 3-hypergraph of hashes onto slots (every step removes a
+        // slot that only one remaining hash maps to), and then assigns the
+        // fingerprints in the reverse order, so that each hash's three slots
+        // xor to its fingerprint. Retries with a new seed until peeling succeeds.
+        consteval auto build(std::span<std::uint64_t const> keys, std::vector<std::uint8_t>& fingerprints) -> layout {
+            layout l = make_layout(std::uint32_t(keys.size()));
+            std::uint64_t rng = 0x726b2b9d438b9d4d;
+
+            for (int attempt = 0; attempt != 100; ++attempt) {
+                // splitmix64
+                rng += 0x9e3779b97f4a7c15;
+                l.seed = murmur64(rng);
+
+                std::vector<std::uint64_t> hashes;
+                for (std::uint64_t k : keys) {
+                    hashes.push_back(murmur64(k + l.seed));
+                }
+                // equal hashes (from equal keys) cannot be peeled, and only
+                // need to be stored once anyway
+                std::ranges::sort(hashes);
+                hashes.erase(std::ranges::unique(hashes).begin(), hashes.end());
+
+                // for every slot: 4 * the number of hashes that map to it, plus
+                // the xor of which of their positions it is; and the xor of them
+                std::vector<std::uint32_t> count(l.array_length, 0);
+                std::vector<std::uint64_t> xors(l.array_length, 0);
+                for (std::uint64_t hash : hashes) {
+                    auto const h = positions(l, hash);
+                    for (std::uint32_t j = 0; j != 3; ++j) {
+                        count[h[j]] = (count[h[j]] + 4) ^ j;
+                        xors[h[j]] ^= hash;
+                    }
+                }
+
+                std::vector<std::uint32_t> alone;
+                for (std::uint32_t i = 0; i != l.array_length; ++i) {
+                    if (count[i] >> 2 == 1) {
+                        alone.push_back(i);
+                    }
+                }
+
+                std::vector<std::uint64_t> order;
+                std::vector<std::uint8_t> order_position;
+                while (not alone.empty()) {
+                    std::uint32_t const index = alone.back();
+                    alone.pop_back();
+                    if (count[index] >> 2 != 1) {
+                        continue;
+                    }
+                    std::uint64_t const hash = xors[index];
+                    std::uint32_t const found = count[index] & 3;
+                    order.push_back(hash);
+                    order_position.push_back(std::uint8_t(found));
+
+                    auto const h = positions(l, hash);
+                    for (std::uint32_t j = 0; j != 3; ++j) {
+                        count[h[j]] = (count[h[j]] - 4) ^ j;
+                        xors[h[j]] ^= hash;
+                        if (j != found and count[h[j]] >> 2 == 1) {
+                            alone.push_back(h[j]);
+                        }
+                    }
+                }
+                if (order.size() != hashes.size()) {
+                    continue;
+                }
+
+                fingerprints.assign(l.array_length, 0);
+                for (std::size_t i = order.size(); i-- != 0; ) {
+                    std::uint64_t const hash = order[i];
+                    auto const h = positions(l, hash);
+                    std::uint32_t const found = order_position[i];
+                    fingerprints[h[found]] = fingerprint(hash)
+                        ^ fingerprints[h[(found + 1) % 3]]
+                        ^ fingerprints[h[(found + 2) % 3]];
+                }
+                return l;
+            }
+
+            fingerprints.clear();
+            return l;
+        }
+
+        // The 64-bit value that a key is hashed from
+        template <class K>
+        constexpr auto key_hash(K const& key) -> std::uint64_t {
+            if constexpr (std::is_enum_v<K>) {
+                return static_cast<std::uint64_t>(std::to_underlying(key));
+            } else if constexpr (std::is_integral_v<K>) {
+                return static_cast<std::uint64_t>(key);
+            } else {
+                static_assert(std::convertible_to<K const&, std::string_view>,
+                              "ctp::fuse_filter keys must be integers, enums, or strings");
+                // FNV-1a
+                std::uint64_t h = 0xcbf29ce484222325;
+                for (char c : std::string_view(key)) {
+                    h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+                }
+                return h;
+            }
+        }
+
+        template <class K>
+        consteval auto make(std::span<K const> keys) -> filter {
+            std::vector<std::uint64_t> hashes;
+            for (K const& k : keys) {
+                hashes.push_back(key_hash(k));
+            }
+            std::vector<std::uint8_t> fingerprints;
+            layout const geometry = build(hashes, fingerprints);
+            if (fingerprints.empty()) {
+                return {.geometry = geometry, .fingerprints = {}, .built = false};
+            }
+            std::meta::info const array = std::meta::reflect_constant_array(fingerprints);
+            return {
+                .geometry = geometry,
+                .fingerprints = std::span(extract<std::uint8_t const*>(array), fingerprints.size()),
+                .built = true,
+            };
+        }
+    }
+}
+
+// An approximate set of the keys in Keys (a ctp::Param of a vector of integers,
+// enums, or strings), built at compile time. contains() never returns false for
+// one of the keys, which is checked at compile time, and returns true for any
+// other value with probability about 1/256. It costs about 9 bits per key for a
+// million keys or more, and about 11 for a few thousand, and every query reads
+// three bytes.
+//
+//      using deny_list = ctp::fuse_filter<load_deny_list()>;
+//      if (deny_list::contains(id) and exact_lookup(id)) { ... }
+template <Param Keys>
+    requires std::ranges::random_access_range<typename decltype(Keys)::type>
+class fuse_filter {
+public:
+    using key_type = decltype(Keys)::type::value_type;
+
+private:
+    static constexpr impl::fuse::filter state = impl::fuse::make(std::span<key_type const>(*Keys));
+    static_assert(state.built, "could not build a ctp::fuse_filter for these keys");
+    static_assert(std::ranges::all_of(*Keys, [](key_type const& k) {
+                      return impl::fuse::contains(state, impl::fuse::key_hash(k));
+                  }),
+                  "ctp::fuse_filter has a false negative");
+
+public:
+    static constexpr auto contains(key_type const& key) -> bool {
+        return impl::fuse::contains(state, impl::fuse::key_hash(key));
+    }
+
+    // The number of keys the filter was built from
+    static constexpr auto size() -> std::size_t { return Keys->size(); }
+
+    // The size of the fingerprint array
+    static constexpr auto size_in_bytes() -> std::size_t { return state.fingerprints.size(); }
+
+    static constexpr auto bits_per_key() -> double {
+        return Keys->empty() ? 0 : 8.0 * size_in_bytes() / Keys->size();
+    }
+};
+
+}
+
+#endif
\ No newline at end of file
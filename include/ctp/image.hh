@@ -0,0 +1,738 @@
+#ifndef CTP_IMAGE_HH
+#define CTP_IMAGE_HH
+
+#include <ctp/core.hh>
+#include <ctp/param.hh>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace ctp {
+
+// A ctp::image is a position-independent encoding of a (target) object graph:
+// one contiguous blob, in which every pointer is replaced by an offset from the
+// start of the blob, so that it can be written out and mmap()-ed by another
+// process and read in place through an image_view<T>.
+//
+// The layout is:
+//
+//      header:    "ctp\0", u32 version, u64 type hash, u64 total size
+//      root:      the inline encoding of the root object
+//      out of line data, in the order it was encountered
+//
+// where the inline encoding of a type is:
+//
+//      scalar:           its object representation (sizeof(T) bytes)
+//      string_view:      u64 offset, u64 size (the chars are null-terminated)
+//      span<T>:          u64 offset, u64 size (the elements are inline encodings)
+//      T[N]:             N inline encodings of T
+//      optional<T>:      u8 engaged, then the inline encoding of T
+//      variant<Ts...>:   u64 index, then the inline encoding of the active
+//                        alternative, padded to the size of the largest one
+//      reference_wrapper<T>:
+//                        u64 offset of the inline encoding of the referent,
+//                        which is stored once however many references it has
+//      tuple<Ts...>:     each element's inline encoding, in order
+//      structural class: each non-static data member's inline encoding, in order
+//
+// Nothing is padded, and scalars are in the native byte order, so an image is
+// only meant to be read on the same platform that built it. Pointers, other
+// references, and classes with base classes cannot be encoded. The type hash
+// covers this layout along with the names of class members and enums, so that
+// an image is only opened as a type that encodes the same way and whose members
+// mean the same thing.
+//
+// Views are read-only and lazy, so they do not have the exact API of the
+// target<T> they were built from: members are reached through get<^^C::m>()
+// rather than .m, spans and arrays are random access ranges without data(),
+// and reference_wrapper<T> reads as the view of its referent.
+
+template <class T>
+class image_view;
+
+namespace impl {
+    enum class image_kind {
+        unsupported,
+        scalar,
+        string,
+        span,
+        array,
+        optional,
+        variant,
+        reference,
+        tuple,
+        aggregate,
+    };
+
+    template <class T>
+    consteval auto image_kind_of() -> image_kind {
+        if constexpr (std::is_arithmetic_v<T> or std::is_enum_v<T>) {
+            return image_kind::scalar;
+        } else if constexpr (std::same_as<T, std::string_view>) {
+            return image_kind::string;
+        } else if constexpr (std::is_bounded_array_v<T>) {
+            return image_kind::array;
+        } else if constexpr (not is_class_type(^^T)) {
+            return image_kind::unsupported;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::span) {
+            return image_kind::span;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::optional) {
+            return image_kind::optional;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::variant) {
+            return image_kind::variant;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::reference_wrapper) {
+            return image_kind::reference;
+        } else if constexpr (has_template_arguments(^^T) and template_of(^^T) == ^^std::tuple) {
+            return image_kind::tuple;
+        } else if constexpr (is_structural_type(^^T)) {
+            return image_kind::aggregate;
+        } else {
+            return image_kind::unsupported;
+        }
+    }
+
+    template <class T>
+    inline constexpr image_kind image_kind_v = image_kind_of<std::remove_cv_t<T>>();
+
+    template <class T>
+    consteval auto image_members() -> std::span<std::meta::info const> {
+        return std::define_static_array(
+            nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+    }
+
+    inline constexpr std::uint32_t image_version = 2;
+    inline constexpr std::size_t image_header_size = 24;
+
+    // The number of bytes T occupies where it is stored, not counting anything
+    // that it points to
+    template <class T>
+    consteval auto image_inline_size() -> std::size_t {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        static_assert(kind != image_kind::unsupported, "this type cannot be stored in a ctp::image");
+        if constexpr (kind == image_kind::scalar) {
+            return sizeof(U);
+        } else if constexpr (kind == image_kind::string or kind == image_kind::span) {
+            return 2 * sizeof(std::uint64_t);
+        } else if constexpr (kind == image_kind::array) {
+            return std::extent_v<U> * image_inline_size<std::remove_extent_t<U>>();
+        } else if constexpr (kind == image_kind::optional) {
+            return 1 + image_inline_size<typename U::value_type>();
+        } else if constexpr (kind == image_kind::variant) {
+            return []<std::size_t... Is>(std::index_sequence<Is...>) {
+                return sizeof(std::uint64_t)
+                    + std::max({image_inline_size<std::variant_alternative_t<Is, U>>()...});
+            }(std::make_index_sequence<std::variant_size_v<U>>());
+        } else if constexpr (kind == image_kind::reference) {
+            return sizeof(std::uint64_t);
+        } else if constexpr (kind == image_kind::tuple) {
+            return []<std::size_t... Is>(std::index_sequence<Is...>) {
+                return (0zu + ... + image_inline_size<std::tuple_element_t<Is, U>>());
+            }(std::make_index_sequence<std::tuple_size_v<U>>());
+        } else {
+            static_assert(bases_of(^^U, std::meta::access_context::unchecked()).empty(),
+                          "classes with base classes cannot be stored in a ctp::image");
+            std::size_t n = 0;
+            template for (constexpr std::meta::info m : image_members<U>()) {
+                static_assert(not is_reference_type(type_of(m)), "references cannot be stored in a ctp::image");
+                n += image_inline_size<typename [: type_of(m) :]>();
+            }
+            return n;
+        }
+    }
+
+    // The offset of the I-th element (of a tuple) or member (of a class)
+    template <class T, std::size_t I>
+    consteval auto image_field_offset() -> std::size_t {
+        std::size_t n = 0;
+        if constexpr (image_kind_v<T> == image_kind::tuple) {
+            template for (constexpr std::size_t J : std::views::iota(0zu, I)) {
+                n += image_inline_size<std::tuple_element_t<J, T>>();
+            }
+        } else {
+            template for (constexpr std::size_t J : std::views::iota(0zu, I)) {
+                n += image_inline_size<typename [: type_of(image_members<T>()[J]) :]>();
+            }
+        }
+        return n;
+    }
+
+    // FNV-1a over the bytes of v, which is all that is needed to tell images of
+    // different layouts apart
+    consteval auto image_hash(std::uint64_t h, std::uint64_t v) -> std::uint64_t {
+        for (int i = 0; i != 8; ++i) {
+            h = (h ^ ((v >> (8 * i)) & 0xff)) * 0x100000001b3;
+        }
+        return h;
+    }
+
+    consteval auto image_hash(std::uint64_t h, std::string_view s) -> std::uint64_t {
+        h = image_hash(h, s.size());
+        for (char c : s) {
+            h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+        }
+        return h;
+    }
+
+    consteval auto image_name_of(std::meta::info r) -> std::string_view {
+        return has_identifier(r) ? identifier_of(r) : std::string_view();
+    }
+
+    // How a scalar is to be interpreted: 0 for unsigned, 1 for signed, 2 for
+    // floating point
+    template <class T>
+    consteval auto image_scalar_class() -> std::uint64_t {
+        if constexpr (std::is_enum_v<T>) {
+            return image_scalar_class<std::underlying_type_t<T>>();
+        } else {
+            return std::is_floating_point_v<T> ? 2 : std::is_signed_v<T> ? 1 : 0;
+        }
+    }
+
+    // Hashes the encoding of T: its kind and inline size, and then the same for
+    // everything it is made of, along with the name of every class member and
+    // enum, so that classes that merely encode the same way are told apart
+    template <class T>
+    consteval auto image_layout_hash(std::uint64_t h = 0xcbf29ce484222325) -> std::uint64_t {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        h = image_hash(h, std::uint64_t(kind));
+        h = image_hash(h, image_inline_size<U>());
+        if constexpr (kind == image_kind::scalar) {
+            h = image_hash(h, image_scalar_class<U>());
+            if constexpr (std::is_enum_v<U>) {
+                h = image_hash(h, image_name_of(^^U));
+            }
+        } else if constexpr (kind == image_kind::span) {
+            h = image_layout_hash<typename U::element_type>(h);
+        } else if constexpr (kind == image_kind::array) {
+            h = image_hash(h, std::extent_v<U>);
+            h = image_layout_hash<std::remove_extent_t<U>>(h);
+        } else if constexpr (kind == image_kind::optional) {
+            h = image_layout_hash<typename U::value_type>(h);
+        } else if constexpr (kind == image_kind::variant) {
+            h = image_hash(h, std::variant_size_v<U>);
+            template for (constexpr std::size_t I : std::views::iota(0zu, std::variant_size_v<U>)) {
+                h = image_layout_hash<std::variant_alternative_t<I, U>>(h);
+            }
+        } else if constexpr (kind == image_kind::reference) {
+            h = image_layout_hash<typename U::type>(h);
+        } else if constexpr (kind == image_kind::tuple) {
+            h = image_hash(h, std::tuple_size_v<U>);
+            template for (constexpr std::size_t I : std::views::iota(0zu, std::tuple_size_v<U>)) {
+                h = image_layout_hash<std::tuple_element_t<I, U>>(h);
+            }
+        } else if constexpr (kind == image_kind::aggregate) {
+            h = image_hash(h, image_members<U>().size());
+            template for (constexpr std::meta::info m : image_members<U>()) {
+                h = image_hash(h, image_name_of(m));
+                h = image_layout_hash<typename [: type_of(m) :]>(h);
+            }
+        }
+        return h;
+    }
+
+    template <class T>
+    inline constexpr std::uint64_t image_type_hash = image_layout_hash<T>();
+
+    template <class T>
+    constexpr auto image_read(char const* p) -> T {
+        std::array<char, sizeof(T)> bytes;
+        std::copy_n(p, sizeof(T), bytes.begin());
+        return std::bit_cast<T>(bytes);
+    }
+
+    class image_writer {
+        // Each object that a reference_wrapper refers to, and where it was
+        // written. The type is part of the key, since a class and its first
+        // member share an address.
+        struct referent {
+            void const* address;
+            std::meta::info type;
+            std::size_t offset;
+        };
+
+        std::vector<char> out;
+        std::vector<referent> referents;
+
+    public:
+        consteval auto size() const -> std::size_t { return out.size(); }
+        consteval auto bytes() const -> std::vector<char> const& { return out; }
+
+        // Reserves n bytes at the end, returning their offset
+        consteval auto allocate(std::size_t n) -> std::size_t {
+            std::size_t const at = out.size();
+            out.resize(at + n);
+            return at;
+        }
+
+        template <class T>
+        consteval auto write_scalar(std::size_t at, T v) -> void {
+            auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(v);
+            std::ranges::copy(bytes, out.begin() + at);
+        }
+
+        template <class T>
+        consteval auto write(std::size_t at, T const& v) -> void {
+            constexpr image_kind kind = image_kind_v<T>;
+            if constexpr (kind == image_kind::scalar) {
+                write_scalar(at, v);
+            } else if constexpr (kind == image_kind::string) {
+                std::size_t const offset = allocate(v.size() + 1);
+                std::ranges::copy(v, out.begin() + offset);
+                write_scalar<std::uint64_t>(at, offset);
+                write_scalar<std::uint64_t>(at + 8, v.size());
+            } else if constexpr (kind == image_kind::span) {
+                using E = std::remove_cv_t<typename T::element_type>;
+                constexpr std::size_t stride = image_inline_size<E>();
+                std::size_t const offset = allocate(v.size() * stride);
+                for (std::size_t i = 0; i != v.size(); ++i) {
+                    write<E>(offset + i * stride, v[i]);
+                }
+                write_scalar<std::uint64_t>(at, offset);
+                write_scalar<std::uint64_t>(at + 8, v.size());
+            } else if constexpr (kind == image_kind::array) {
+                using E = std::remove_cv_t<std::remove_extent_t<T>>;
+                constexpr std::size_t stride = image_inline_size<E>();
+                for (std::size_t i = 0; i != std::extent_v<T>; ++i) {
+                    write<E>(at + i * stride, v[i]);
+                }
+            } else if constexpr (kind == image_kind::optional) {
+                write_scalar<std::uint8_t>(at, v.has_value());
+                if (v) {
+                    write<typename T::value_type>(at + 1, *v);
+                }
+            } else if constexpr (kind == image_kind::variant) {
+                write_scalar<std::uint64_t>(at, v.index());
+                template for (constexpr std::size_t I : std::views::iota(0zu, std::variant_size_v<T>)) {
+                    if (I == v.index()) {
+                        write<std::remove_cv_t<std::variant_alternative_t<I, T>>>(at + 8, std::get<I>(v));
+                    }
+                }
+            } else if constexpr (kind == image_kind::reference) {
+                using R = std::remove_cv_t<typename T::type>;
+                void const* const address = std::addressof(v.get());
+                auto const known = std::ranges::find_if(referents, [&](referent const& r) {
+                    return r.address == address and r.type == ^^R;
+                });
+                std::size_t offset;
+                if (known != referents.end()) {
+                    offset = known->offset;
+                } else {
+                    // registered before it is written, so that a cycle ends here
+                    offset = allocate(image_inline_size<R>());
+                    referents.push_back({address, ^^R, offset});
+                    write<R>(offset, v.get());
+                }
+                write_scalar<std::uint64_t>(at, offset);
+            } else if constexpr (kind == image_kind::tuple) {
+                template for (constexpr std::size_t I : std::views::iota(0zu, std::tuple_size_v<T>)) {
+                    write<std::tuple_element_t<I, T>>(at + image_field_offset<T, I>(), std::get<I>(v));
+                }
+            } else {
+                template for (constexpr std::size_t I : std::views::iota(0zu, image_members<T>().size())) {
+                    constexpr std::meta::info m = image_members<T>()[I];
+                    write<std::remove_cv_t<typename [: type_of(m) :]>>(
+                        at + image_field_offset<T, I>(), v.[: m :]);
+                }
+            }
+        }
+    };
+
+    template <class T>
+    consteval auto make_image(T const& v) -> std::span<char const> {
+        image_writer w;
+        w.allocate(image_header_size + image_inline_size<T>());
+        w.write(image_header_size, v);
+
+        w.write_scalar<std::array<char, 4>>(0, {'c', 't', 'p', '\0'});
+        w.write_scalar<std::uint32_t>(4, image_version);
+        w.write_scalar<std::uint64_t>(8, image_type_hash<T>);
+        w.write_scalar<std::uint64_t>(16, w.size());
+        return std::define_static_array(w.bytes());
+    }
+
+    // What reading a T out of an image gives back: scalars and strings are
+    // read directly, everything else is a view
+    template <class T>
+    constexpr auto image_load(char const* base, std::size_t pos) {
+        using U = std::remove_cv_t<T>;
+        if constexpr (image_kind_v<U> == image_kind::scalar) {
+            return image_read<U>(base + pos);
+        } else if constexpr (image_kind_v<U> == image_kind::string) {
+            return std::string_view(base + image_read<std::uint64_t>(base + pos),
+                                    image_read<std::uint64_t>(base + pos + 8));
+        } else if constexpr (image_kind_v<U> == image_kind::reference) {
+            return image_load<typename U::type>(base, image_read<std::uint64_t>(base + pos));
+        } else {
+            return image_view<U>(base, pos);
+        }
+    }
+
+    template <class T>
+    using image_value_t = decltype(image_load<T>(nullptr, 0));
+
+    // Whether the encoding of T contains any offsets or variant indices, i.e.
+    // whether there is anything for image_check to do
+    template <class T>
+    consteval auto image_needs_check() -> bool {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        if constexpr (kind == image_kind::scalar) {
+            return false;
+        } else if constexpr (kind == image_kind::string
+                          or kind == image_kind::span
+                          or kind == image_kind::variant
+                          or kind == image_kind::reference) {
+            return true;
+        } else if constexpr (kind == image_kind::array) {
+            return image_needs_check<std::remove_extent_t<U>>();
+        } else if constexpr (kind == image_kind::optional) {
+            return image_needs_check<typename U::value_type>();
+        } else if constexpr (kind == image_kind::tuple) {
+            return []<std::size_t... Is>(std::index_sequence<Is...>) {
+                return (false or ... or image_needs_check<std::tuple_element_t<Is, U>>());
+            }(std::make_index_sequence<std::tuple_size_v<U>>());
+        } else {
+            bool any = false;
+            template for (constexpr std::meta::info m : image_members<U>()) {
+                any = any or image_needs_check<typename [: type_of(m) :]>();
+            }
+            return any;
+        }
+    }
+
+    // The referents that image_check has already checked, by offset and type
+    // hash, so that each is checked once and cycles terminate
+    class image_visited {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> seen;
+
+    public:
+        // Whether this is the first visit
+        constexpr auto insert(std::uint64_t offset, std::uint64_t type) -> bool {
+            std::pair const key(offset, type);
+            auto const it = std::ranges::lower_bound(seen, key);
+            if (it != seen.end() and *it == key) {
+                return false;
+            }
+            seen.insert(it, key);
+            return true;
+        }
+    };
+
+    template <class T>
+    constexpr auto image_check(char const* base, std::size_t pos, std::size_t total, image_visited& seen) -> bool;
+
+    // Checks the active alternative of the variant at pos, whose index is
+    // already known to be valid
+    template <class T, std::size_t... Is>
+    constexpr auto image_check_alternative(char const* base, std::size_t pos, std::size_t total,
+                                           image_visited& seen, std::uint64_t index,
+                                           std::index_sequence<Is...>) -> bool {
+        return ((index == Is and image_check<std::variant_alternative_t<Is, T>>(base, pos + 8, total, seen)) or ...);
+    }
+
+    // Checks that everything the T at pos (whose inline encoding is already
+    // known to be in bounds) refers to lies within the first total bytes, and
+    // that every variant index is valid
+    template <class T>
+    constexpr auto image_check(char const* base, std::size_t pos, std::size_t total, image_visited& seen) -> bool {
+        using U = std::remove_cv_t<T>;
+        constexpr image_kind kind = image_kind_v<U>;
+        if constexpr (not image_needs_check<U>()) {
+            return true;
+        } else if constexpr (kind == image_kind::string) {
+            std::uint64_t const offset = image_read<std::uint64_t>(base + pos);
+            std::uint64_t const size = image_read<std::uint64_t>(base + pos + 8);
+            // the chars and their null terminator
+            return offset < total and size < total - offset;
+        } else if constexpr (kind == image_kind::span) {
+            using E = std::remove_cv_t<typename U::element_type>;
+            constexpr std::size_t stride = image_inline_size<E>();
+            std::uint64_t const offset = image_read<std::uint64_t>(base + pos);
+            std::uint64_t const size = image_read<std::uint64_t>(base + pos + 8);
+            if constexpr (stride == 0) {
+                return offset <= total;
+            } else {
+                if (offset > total or size > (total - offset) / stride) {
+                    return false;
+                }
+                if constexpr (image_needs_check<E>()) {
+                    for (std::size_t i = 0; i != size; ++i) {
+                        if (not image_check<E>(base, offset + i * stride, total, seen)) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+        } else if constexpr (kind == image_kind::array) {
+            using E = std::remove_cv_t<std::remove_extent_t<U>>;
+            constexpr std::size_t stride = image_inline_size<E>();
+            for (std::size_t i = 0; i != std::extent_v<U>; ++i) {
+                if (not image_check<E>(base, pos + i * stride, total, seen)) {
+                    return false;
+                }
+            }
+            return true;
+        } else if constexpr (kind == image_kind::optional) {
+            return image_read<std::uint8_t>(base + pos) == 0
+                or image_check<typename U::value_type>(base, pos + 1, total, seen);
+        } else if constexpr (kind == image_kind::variant) {
+            std::uint64_t const index = image_read<std::uint64_t>(base + pos);
+            return index < std::variant_size_v<U>
+                and image_check_alternative<U>(base, pos, total, seen, index,
+                                               std::make_index_sequence<std::variant_size_v<U>>());
+        } else if constexpr (kind == image_kind::reference) {
+            using R = std::remove_cv_t<typename U::type>;
+            std::uint64_t const offset = image_read<std::uint64_t>(base + pos);
+            if (offset > total or image_inline_size<R>() > total - offset) {
+                return false;
+            }
+            return not seen.insert(offset, image_type_hash<R>) or image_check<R>(base, offset, total, seen);
+        } else if constexpr (kind == image_kind::tuple) {
+            bool ok = true;
+            template for (constexpr std::size_t I : std::views::iota(0zu, std::tuple_size_v<U>)) {
+                ok = ok and image_check<std::tuple_element_t<I, U>>(base, pos + image_field_offset<U, I>(), total, seen);
+            }
+            return ok;
+        } else {
+            bool ok = true;
+            template for (constexpr std::size_t I : std::views::iota(0zu, image_members<U>().size())) {
+                ok = ok and image_check<typename [: type_of(image_members<U>()[I]) :]>(
+                    base, pos + image_field_offset<U, I>(), total, seen);
+            }
+            return ok;
+        }
+    }
+
+    // Random access over n consecutive inline encodings of T
+    template <class T>
+    class image_range {
+        static constexpr std::size_t stride = image_inline_size<T>();
+
+        char const* base_ = nullptr;
+        std::size_t pos_ = 0;
+        std::size_t size_ = 0;
+
+    public:
+        class iterator {
+            char const* base = nullptr;
+            std::size_t pos = 0;
+
+        public:
+            using value_type = image_value_t<T>;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::random_access_iterator_tag;
+
+            constexpr iterator() = default;
+            constexpr iterator(char const* b, std::size_t p) : base(b), pos(p) { }
+
+            constexpr auto operator*() const -> value_type { return image_load<T>(base, pos); }
+            constexpr auto operator[](difference_type n) const -> value_type { return *(*this + n); }
+
+            constexpr auto operator++() -> iterator& { pos += stride; return *this; }
+            constexpr auto operator++(int) -> iterator { auto tmp = *this; ++*this; return tmp; }
+            constexpr auto operator--() -> iterator& { pos -= stride; return *this; }
+            constexpr auto operator--(int) -> iterator { auto tmp = *this; --*this; return tmp; }
+            constexpr auto operator+=(difference_type n) -> iterator& { pos += n * stride; return *this; }
+            constexpr auto operator-=(difference_type n) -> iterator& { pos -= n * stride; return *this; }
+
+            friend constexpr auto operator+(iterator it, difference_type n) -> iterator { return it += n; }
+            friend constexpr auto operator+(difference_type n, iterator it) -> iterator { return it += n; }
+            friend constexpr auto operator-(iterator it, difference_type n) -> iterator { return it -= n; }
+            friend constexpr auto operator-(iterator const& a, iterator const& b) -> difference_type {
+                return (difference_type(a.pos) - difference_type(b.pos)) / difference_type(stride);
+            }
+            friend constexpr auto operator==(iterator const& a, iterator const& b) -> bool { return a.pos == b.pos; }
+            friend constexpr auto operator<=>(iterator const& a, iterator const& b) { return a.pos <=> b.pos; }
+        };
+
+        constexpr image_range() = default;
+        constexpr image_range(char const* base, std::size_t pos, std::size_t size)
+            : base_(base), pos_(pos), size_(size) { }
+
+        constexpr auto size() const -> std::size_t { return size_; }
+        constexpr auto empty() const -> bool { return size_ == 0; }
+        constexpr auto operator[](std::size_t i) const -> image_value_t<T> {
+            return image_load<T>(base_, pos_ + i * stride);
+        }
+        constexpr auto front() const -> image_value_t<T> { return (*this)[0]; }
+        constexpr auto back() const -> image_value_t<T> { return (*this)[size_ - 1]; }
+        constexpr auto begin() const -> iterator { return iterator(base_, pos_); }
+        constexpr auto end() const -> iterator { return iterator(base_, pos_ + size_ * stride); }
+    };
+}
+
+// Reading a span<T> in an image gives a random access range of T (or of views of T)
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::span)
+class image_view<T> : public impl::image_range<std::remove_cv_t<typename T::element_type>> {
+public:
+    constexpr image_view(char const* base, std::size_t pos)
+        : impl::image_range<std::remove_cv_t<typename T::element_type>>(
+            base,
+            impl::image_read<std::uint64_t>(base + pos),
+            impl::image_read<std::uint64_t>(base + pos + 8))
+    { }
+};
+
+// Likewise for T[N]
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::array)
+class image_view<T> : public impl::image_range<std::remove_cv_t<std::remove_extent_t<T>>> {
+public:
+    constexpr image_view(char const* base, std::size_t pos)
+        : impl::image_range<std::remove_cv_t<std::remove_extent_t<T>>>(base, pos, std::extent_v<T>)
+    { }
+};
+
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::optional)
+class image_view<T> {
+    char const* base;
+    std::size_t pos;
+
+public:
+    constexpr image_view(char const* b, std::size_t p) : base(b), pos(p) { }
+
+    constexpr auto has_value() const -> bool { return impl::image_read<std::uint8_t>(base + pos) != 0; }
+    constexpr explicit operator bool() const { return has_value(); }
+    constexpr auto operator*() const -> impl::image_value_t<typename T::value_type> {
+        return impl::image_load<typename T::value_type>(base, pos + 1);
+    }
+    constexpr auto value() const -> impl::image_value_t<typename T::value_type> {
+        if (not has_value()) {
+            throw std::bad_optional_access();
+        }
+        return **this;
+    }
+};
+
+// Reading a variant gives its index() and get<I>(), which throws
+// std::bad_variant_access unless I is the index
+template <class T> requires (impl::image_kind_v<T> == impl::image_kind::variant)
+class image_view<T> {
+    char const* base;
+    std::size_t pos;
+
+public:
+    constexpr image_view(char const* b, std::size_t p) : base(b), pos(p) { }
+
+    constexpr auto index() const -> std::size_t {
+        return std::size_t(impl::image_read<std::uint64_t>(base + pos));
+    }
+
+    template <std::size_t I>
+    constexpr auto get() const -> impl::image_value_t<std::variant_alternative_t<I, T>> {
+        if (index() != I) {
+            throw std::bad_variant_access();
+        }
+        return impl::image_load<std::variant_alternative_t<I, T>>(base, pos + 8);
+    }
+
+    template <std::size_t I>
+    friend constexpr auto get(image_view const& v) { return v.template get<I>(); }
+};
+
+// Tuples and structural classes: get<I>() for the I-th element or member, and
+// for classes get<^^C::m>() as well
+template <class T>
+    requires (impl::image_kind_v<T> == impl::image_kind::tuple
+           or impl::image_kind_v<T> == impl::image_kind::aggregate)
+class image_view<T> {
+    char const* base;
+    std::size_t pos;
+
+    template <std::size_t I>
+    static consteval auto field_type() -> std::meta::info {
+        if constexpr (impl::image_kind_v<T> == impl::image_kind::tuple) {
+            return ^^std::tuple_element_t<I, T>;
+        } else {
+            return remove_cv(type_of(impl::image_members<T>()[I]));
+        }
+    }
+
+public:
+    constexpr image_view(char const* b, std::size_t p) : base(b), pos(p) { }
+
+    template <std::size_t I>
+    constexpr auto get() const {
+        return impl::image_load<typename [: field_type<I>() :]>(base, pos + impl::image_field_offset<T, I>());
+    }
+
+    template <std::meta::info M>
+        requires (impl::image_kind_v<T> == impl::image_kind::aggregate)
+    constexpr auto get() const {
+        constexpr std::size_t I = [] {
+            auto members = impl::image_members<T>();
+            return std::size_t(std::ranges::find(members, M) - members.begin());
+        }();
+        static_assert(I != impl::image_members<T>().size(), "not a non-static data member of T");
+        return get<I>();
+    }
+
+    template <std::size_t I>
+    friend constexpr auto get(image_view const& v) { return v.template get<I>(); }
+};
+
+// Checks that bytes holds an image of a T (as produced by ctp::image) and
+// returns a view of its root, or nullopt if it does not. Besides the header,
+// every offset and size in the image is checked against its total size, so
+// that nothing read through the view can go out of bounds, and every variant
+// index against its number of alternatives. This takes time linear in the
+// number of strings, span elements, and referents in the image.
+template <class T>
+constexpr auto open_image(std::span<char const> bytes) -> std::optional<impl::image_value_t<T>> {
+    if (bytes.size() < impl::image_header_size
+        or not std::ranges::equal(bytes.first(4), std::array{'c', 't', 'p', '\0'})
+        or impl::image_read<std::uint32_t>(bytes.data() + 4) != impl::image_version
+        or impl::image_read<std::uint64_t>(bytes.data() + 8) != impl::image_type_hash<T>) {
+        return std::nullopt;
+    }
+    std::uint64_t const total = impl::image_read<std::uint64_t>(bytes.data() + 16);
+    impl::image_visited seen;
+    if (total > bytes.size()
+        or total < impl::image_header_size + impl::image_inline_size<T>()
+        or not impl::image_check<T>(bytes.data(), impl::image_header_size, total, seen)) {
+        return std::nullopt;
+    }
+    return impl::image_load<T>(bytes.data(), impl::image_header_size);
+}
+
+template <class T>
+auto open_image(std::span<std::byte const> bytes) -> std::optional<impl::image_value_t<T>> {
+    return open_image<T>(std::span(reinterpret_cast<char const*>(bytes.data()), bytes.size()));
+}
+
+// The image of the value of the ctp::Param V, built at compile time
+//
+//      using config_image = ctp::image<Config{...}>;
+//      write(fd, config_image::bytes.data(), config_image::bytes.size());
+//
+//      // elsewhere, on the mmap()-ed file:
+//      auto config = ctp::open_image<config_image::type>(mapped);
+template <Param V>
+struct image {
+    using type = decltype(V)::type;
+
+    static constexpr std::span<char const> bytes = impl::make_image<type>(V.get());
+
+    static constexpr auto size() -> std::size_t { return bytes.size(); }
+    static constexpr auto root() -> impl::image_value_t<type> {
+        return impl::image_load<type>(bytes.data(), impl::image_header_size);
+    }
+};
+
+}
+
+#endif
\ No newline at end of file
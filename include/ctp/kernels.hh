@@ -0,0 +1,198 @@
+#ifndef CTP_KERNELS_HH
+#define CTP_KERNELS_HH
+
+#include <ctp/core.hh>
+#include <ctp/param.hh>
+#include <ctp/custom.hh>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ctp {
+
+// Numeric kernels whose coefficients are template parameters. Every loop over
+// the coefficients is unrolled at compile time, terms with a zero coefficient
+// are dropped, and multiplications by 1, -1, and 2 become a copy, a negation,
+// and an addition. The loops over the data are left as simple counted loops
+// for the compiler to vectorize.
+
+namespace impl {
+    template <double C, class T>
+    constexpr auto scale(T const& v) -> T {
+        if constexpr (C == 1) {
+            return v;
+        } else if constexpr (C == -1) {
+            return -v;
+        } else if constexpr (C == 2) {
+            return v + v;
+        } else {
+            return T(C) * v;
+        }
+    }
+
+    // acc + C * v, for a non-zero C
+    template <double C, class T>
+    constexpr auto multiply_add(T const& acc, T const& v) -> T {
+        if constexpr (C == -1) {
+            return acc - v;
+        } else {
+            return acc + scale<C>(v);
+        }
+    }
+
+    // The number of coefficients, ignoring any trailing zeroes
+    consteval auto significant_size(std::span<double const> cs) -> std::size_t {
+        std::size_t n = cs.size();
+        while (n != 0 and cs[n - 1] == 0) {
+            --n;
+        }
+        return n;
+    }
+
+    // Whether every coefficient survives conversion to T, which is only in
+    // question for integral T
+    template <class T>
+    consteval auto exactly_representable(std::span<double const> cs) -> bool {
+        if constexpr (std::is_integral_v<T>) {
+            return std::ranges::all_of(cs, [](double c){
+                // max() / 2 + 1 is a power of two, so this bound is exact
+                return c >= double(std::numeric_limits<T>::lowest())
+                   and c < 2 * double(std::numeric_limits<T>::max() / 2 + 1)
+                   and double(T(c)) == c;
+            });
+        } else {
+            return true;
+        }
+    }
+}
+
+// The polynomial Coeffs[0] + Coeffs[1] * x + Coeffs[2] * x^2 + ...,
+// evaluated with Horner's method
+template <Param<std::vector<double>> Coeffs>
+struct polynomial {
+    static constexpr std::size_t degree_bound = impl::significant_size(*Coeffs);
+
+    template <class T>
+    static constexpr auto operator()(T const& x) -> T {
+        static_assert(impl::exactly_representable<T>(*Coeffs),
+                      "every coefficient must be exactly representable as T");
+        if constexpr (degree_bound == 0) {
+            return T(0);
+        } else {
+            constexpr std::size_t d = degree_bound - 1;
+            if constexpr (d == 0) {
+                return T((*Coeffs)[0]);
+            } else {
+                // the leading term, c[d] * x, without a separate multiplication
+                T r = impl::scale<(*Coeffs)[d]>(x);
+                template for (constexpr std::size_t k : std::views::iota(1zu, d + 1)) {
+                    constexpr std::size_t i = d - k;
+                    constexpr double c = (*Coeffs)[i];
+                    if constexpr (c != 0) {
+                        r = r + T(c);
+                    }
+                    if constexpr (i != 0) {
+                        r = r * x;
+                    }
+                }
+                return r;
+            }
+        }
+    }
+
+    template <class T>
+    static constexpr auto apply(std::span<T const> in, std::span<T> out) -> void {
+        for (std::size_t i = 0; i != in.size(); ++i) {
+            out[i] = operator()(in[i]);
+        }
+    }
+};
+
+// A finite impulse response filter: out[i] = sum over k of Taps[k] * in[i + N - 1 - k],
+// for the N taps. Only full windows are produced, so out must have room for
+// in.size() - N + 1 values.
+template <Param<std::vector<double>> Taps>
+    requires (Taps->size() > 0)
+struct fir {
+    static constexpr std::size_t size = Taps->size();
+
+    template <class T>
+    static constexpr auto at(T const* window) -> T {
+        static_assert(impl::exactly_representable<T>(*Taps),
+                      "every tap must be exactly representable as T");
+        T acc = T(0);
+        template for (constexpr std::size_t k : std::views::iota(0zu, size)) {
+            constexpr double c = (*Taps)[k];
+            if constexpr (c != 0) {
+                acc = impl::multiply_add<c>(acc, window[size - 1 - k]);
+            }
+        }
+        return acc;
+    }
+
+    template <class T>
+    static constexpr auto apply(std::span<T const> in, std::span<T> out) -> void {
+        if (in.size() < size) {
+            return;
+        }
+        std::size_t const n = in.size() - size + 1;
+        for (std::size_t i = 0; i != n; ++i) {
+            out[i] = at(in.data() + i);
+        }
+    }
+};
+
+// Multiplication by the constant matrix M, given as a non-empty vector of
+// non-empty rows
+template <Param<std::vector<std::vector<double>>> M>
+    requires (M->size() > 0 and (*M)[0].size() > 0)
+struct matvec {
+    static constexpr std::size_t rows = M->size();
+    static constexpr std::size_t cols = (*M)[0].size();
+
+    static_assert([]{
+        for (auto row : *M) {
+            if (row.size() != cols) {
+                return false;
+            }
+        }
+        return true;
+    }(), "every row of M must have the same size");
+
+    template <class T>
+    static constexpr auto operator()(std::array<T, cols> const& x) -> std::array<T, rows> {
+        static_assert(std::ranges::all_of(*M, [](auto const& row){ return impl::exactly_representable<T>(row); }),
+                      "every entry of M must be exactly representable as T");
+        std::array<T, rows> y;
+        template for (constexpr std::size_t r : std::views::iota(0zu, rows)) {
+            T acc = T(0);
+            template for (constexpr std::size_t c : std::views::iota(0zu, cols)) {
+                constexpr double m = (*M)[r][c];
+                if constexpr (m != 0) {
+                    acc = impl::multiply_add<m>(acc, x[c]);
+                }
+            }
+            y[r] = acc;
+        }
+        return y;
+    }
+
+    // Applies the matrix to each of in.size() / cols vectors stored back to back
+    template <class T>
+    static constexpr auto apply(std::span<T const> in, std::span<T> out) -> void {
+        for (std::size_t v = 0; v != in.size() / cols; ++v) {
+            std::array<T, cols> x;
+            std::copy_n(in.data() + v * cols, cols, x.begin());
+            auto const y = operator()(x);
+            std::copy_n(y.begin(), rows, out.data() + v * rows);
+        }
+    }
+};
+
+}
+
+#endif
\ No newline at end of file
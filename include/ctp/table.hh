@@ -0,0 +1,164 @@
+#ifndef CTP_TABLE_HH
+#define CTP_TABLE_HH
+
+#include <ctp/core.hh>
+#include <ctp/param.hh>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mdspan>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ctp {
+
+namespace impl {
+    template <std::size_t> using table_index = std::size_t;
+
+    template <class F, class Extents, class = std::make_index_sequence<Extents::rank()>>
+    struct table_result;
+
+    template <class F, class Extents, std::size_t... Is>
+    struct table_result<F, Extents, std::index_sequence<Is...>> {
+        using type = std::remove_cvref_t<std::invoke_result_t<F const&, table_index<Is>...>>;
+    };
+
+    template <class Extents>
+    consteval auto static_size() -> std::size_t {
+        std::size_t total = 1;
+        for (std::size_t r = 0; r != Extents::rank(); ++r) {
+            total *= Extents::static_extent(r);
+        }
+        return total;
+    }
+
+    // Evaluates f over a row-major multi-dimensional domain and returns the
+    // (shared, static) array of results, as produced by ctp::reflect_constant_array.
+    // Since that array is a template parameter object keyed on its contents, every
+    // table with the same values refers to the same storage.
+    template <class T, class Extents>
+    consteval auto tabulate(auto const& f) -> target<T> const* {
+        constexpr std::size_t rank = Extents::rank();
+        std::vector<T> values;
+        std::array<std::size_t, rank> index = {};
+        for (std::size_t n = 0; n != static_size<Extents>(); ++n) {
+            values.push_back(static_cast<T>(std::apply(f, index)));
+            // odometer increment, last dimension fastest
+            for (std::size_t r = rank; r-- != 0; ) {
+                if (++index[r] != Extents::static_extent(r)) {
+                    break;
+                }
+                index[r] = 0;
+            }
+        }
+        return extract<target<T> const*>(reflect_constant_array(values));
+    }
+}
+
+// A lookup table of F(0), F(1), ..., F(N-1), evaluated at compile time. F can be
+// any callable that is usable in constant evaluation, including a consteval one,
+// and each result is converted to T.
+//
+//      constexpr auto crc32_entry = [](std::size_t i) consteval { ... };
+//      using crc32_table = ctp::table<crc32_entry, 256, std::uint32_t>;
+//
+//      crc = crc32_table::values[(crc ^ byte) & 0xff] ^ (crc >> 8);
+template <auto F,
+          std::size_t N,
+          class T = impl::table_result<decltype(F), std::extents<std::size_t, N>>::type>
+    requires (N > 0)
+struct table {
+    using value_type = target<T>;
+
+    static constexpr std::span<value_type const, N> values{
+        impl::tabulate<T, std::extents<std::size_t, N>>(F), N};
+
+    static constexpr auto size() -> std::size_t { return N; }
+    static constexpr auto data() -> value_type const* { return values.data(); }
+    static constexpr auto begin() { return values.begin(); }
+    static constexpr auto end() { return values.end(); }
+    static constexpr auto operator[](std::size_t i) -> value_type const& { return values[i]; }
+};
+
+// The multi-dimensional form of ctp::table. F is called with one index per
+// dimension of Extents, which must all be static, and the results are stored
+// row-major.
+//
+//      using gamma = ctp::table_nd<[](std::size_t ch, std::size_t v) { ... },
+//                                  std::extents<std::size_t, 3, 256>,
+//                                  std::uint8_t>;
+//      gamma::view[1, v];
+template <auto F,
+          class Extents,
+          class T = impl::table_result<decltype(F), Extents>::type>
+    requires (Extents::rank_dynamic() == 0 && impl::static_size<Extents>() > 0)
+struct table_nd {
+    using value_type = target<T>;
+
+    static constexpr std::mdspan<value_type const, Extents> view{impl::tabulate<T, Extents>(F)};
+
+    static constexpr auto extents() -> Extents { return {}; }
+    static constexpr auto size() -> std::size_t { return view.size(); }
+    static constexpr auto data() -> value_type const* { return view.data_handle(); }
+    static constexpr auto values() -> std::span<value_type const> { return {data(), size()}; }
+};
+
+// What a sampled_table does with an input outside of [Lo, Hi]: clamp it to the
+// nearest end, or treat F as periodic with period Hi - Lo.
+enum class range_reduction {
+    clamp,
+    periodic,
+};
+
+// A table of N evenly spaced samples of F over [Lo, Hi], converted to T, that
+// approximates F for any input by linear interpolation between neighboring
+// samples (rounded to the nearest value, for integral T).
+//
+//      using fast_sin = ctp::sampled_table<sin_impl, 0.0, 2 * pi, 1024,
+//                                          float, ctp::range_reduction::periodic>;
+//      fast_sin{}(angle);
+template <auto F,
+          double Lo,
+          double Hi,
+          std::size_t N,
+          class T = double,
+          range_reduction Reduction = range_reduction::clamp>
+    requires (N >= 2 && Lo < Hi && std::is_arithmetic_v<T>)
+struct sampled_table {
+    static constexpr double step = (Hi - Lo) / (N - 1);
+
+    static constexpr std::span<T const, N> values{
+        impl::tabulate<T, std::extents<std::size_t, N>>(
+            [](std::size_t i) { return F(Lo + step * i); }),
+        N};
+
+    static constexpr auto operator()(double x) -> T {
+        if constexpr (Reduction == range_reduction::periodic) {
+            double periods = (x - Lo) / (Hi - Lo);
+            auto whole = static_cast<long long>(periods);
+            if (whole > periods) {
+                --whole;
+            }
+            x -= whole * (Hi - Lo);
+        } else {
+            x = x < Lo ? Lo : x > Hi ? Hi : x;
+        }
+
+        double const pos = (x - Lo) / step;
+        std::size_t const i = pos < N - 2 ? static_cast<std::size_t>(pos) : N - 2;
+        double const frac = pos - i;
+        // in double, since values[i + 1] - values[i] can wrap for unsigned T
+        double const v = double(values[i]) + (double(values[i + 1]) - double(values[i])) * frac;
+        if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(v < 0 ? v - 0.5 : v + 0.5);
+        } else {
+            return static_cast<T>(v);
+        }
+    }
+};
+
+}
+
+#endif
\ No newline at end of file
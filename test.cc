@@ -7,6 +7,37 @@ constexpr int const& r1 = ctp::define_static_object(1);
 constexpr int const& r2 = ctp::define_static_object(1);
 static_assert(&r1 == &r2);
 
+CTP_EXTERN_PARAM(std::string, greeting);
+CTP_INSTANTIATE_PARAM(std::string, greeting, "hello");
+static_assert(greeting == std::string_view("hello"));
+static_assert(&greeting == &ctp::define_static_object(std::string("hello")));
+
+consteval auto repetitive_bytes(size_t n) -> std::vector<std::byte> {
+    std::vector<std::byte> v;
+    for (size_t i = 0; i != n; ++i) {
+        v.push_back(std::byte("abracadabra"[i % 11]));
+    }
+    return v;
+}
+
+// n well-spread 64-bit keys, starting from the first
+consteval auto spread_keys(std::uint64_t first, std::uint64_t n) -> std::vector<std::uint64_t> {
+    std::vector<std::uint64_t> v;
+    for (std::uint64_t i = first; i != first + n; ++i) {
+        v.push_back(i * 0x9e3779b97f4a7c15);
+    }
+    return v;
+}
+
+enum class Feature { a, b, c = 5 };
+enum class Sparse : unsigned { lo = 1, hi = 1u << 20 };
+enum class Narrow : std::int8_t { lo = -100, hi = 100 };
+enum class Toggle : bool { off, on };
+
+struct Point { int x; double y; };
+struct Sample { int count; double mean; };
+inline constexpr Point origin = {0, 0.5};
+
 template <ctp::Param V>
 struct X {
     static constexpr auto& value = V.value;
@@ -86,6 +117,12 @@ int main() {
         static_assert(std::same_as<decltype(v1), decltype(v2)>);
         static_assert(std::get<int>(v1.value) == 1);
         static_assert(std::get<std::string_view>(v3.value) == "hello");
+
+        X<std::variant<int, std::string, double>(2.5)> v4;
+        X<std::variant<int, std::string, double>(2)> v5;
+        static_assert(!std::same_as<decltype(v4), decltype(v5)>);
+        static_assert(std::get<2>(v4.value) == 2.5);
+        static_assert(std::get<0>(v5.value) == 2);
     }
 
     {
@@ -137,4 +174,205 @@ int main() {
         static_assert(a.value.data() == arr);
         static_assert(b.value.data() == arr);
     }
+
+    {
+        using C = ctp::compressed<repetitive_bytes(1000), ctp::compression::balanced, 256>;
+        using S = ctp::compressed<repetitive_bytes(1000), ctp::compression::none, 256>;
+        static_assert(C::size() == 1000);
+        static_assert(C::block_count() == 4);
+        static_assert(C::compressed_size() < C::size());
+        static_assert(S::compressed_size() == S::size());
+        static_assert([]{
+            std::array<std::byte, 1000> out{};
+            C::decompress(out);
+            return std::ranges::equal(out, repetitive_bytes(1000));
+        }());
+        static_assert([]{
+            std::array<std::byte, 1000> out{};
+            S::decompress(out);
+            return std::ranges::equal(out, repetitive_bytes(1000));
+        }());
+
+        // the runtime paths: data() decompresses once into a static buffer,
+        // chunks() one block at a time
+        static_assert(std::ranges::input_range<decltype(C::chunks())>);
+        std::span<std::byte const> all = C::data();
+        if (all.data() != C::data().data() or not std::ranges::equal(all, S::data())) {
+            return 1;
+        }
+        size_t offset = 0;
+        for (std::span<std::byte const> chunk : C::chunks()) {
+            if (not std::ranges::equal(chunk, all.subspan(offset, chunk.size()))) {
+                return 1;
+            }
+            offset += chunk.size();
+        }
+        if (offset != C::size()) {
+            return 1;
+        }
+    }
+
+    {
+        using squares = ctp::table<[](size_t i) { return i * i; }, 8>;
+        using also_squares = ctp::table<[](size_t i) consteval { return int(i * i); }, 8, size_t>;
+        static_assert(squares::size() == 8);
+        static_assert(squares::values[3] == 9);
+        static_assert(squares::data() == also_squares::data());
+
+        using grid = ctp::table_nd<[](size_t r, size_t c) { return int(10 * r + c); },
+                                   std::extents<size_t, 2, 3>>;
+        static_assert(grid::size() == 6);
+        static_assert(grid::view[1, 2] == 12);
+
+        using ramp = ctp::sampled_table<[](double x) { return 2 * x; }, 0.0, 1.0, 5>;
+        static_assert(ramp{}(0.25) == 0.5);
+        static_assert(ramp{}(0.375) == 0.75);
+        static_assert(ramp{}(-1.0) == 0.0);
+        static_assert(ramp{}(2.0) == 2.0);
+
+        using wave = ctp::sampled_table<[](double x) { return x * (1 - x); }, 0.0, 1.0, 5,
+                                        double, ctp::range_reduction::periodic>;
+        static_assert(wave{}(1.25) == wave{}(0.25));
+        static_assert(wave{}(-0.75) == wave{}(0.25));
+
+        using falling = ctp::sampled_table<[](double x) { return 10 - 3 * x; }, 0.0, 1.0, 2, std::uint32_t>;
+        static_assert(falling::values[0] == 10 and falling::values[1] == 7);
+        static_assert(falling{}(0.5) == 9);
+        static_assert(falling{}(0.9) == 7);
+        static_assert(falling{}(2.0) == 7);
+    }
+
+    {
+        X<std::bitset<8>(5)> a;
+        X<std::bitset<8>("101")> b;
+        X<std::bitset<8>(6)> c;
+        static_assert(std::same_as<decltype(a), decltype(b)>);
+        static_assert(!std::same_as<decltype(a), decltype(c)>);
+        static_assert(std::same_as<decltype(a.value), ctp::bitmask<8> const&>);
+        static_assert(a.value.test(0) and not a.value.test(1) and a.value.test(2));
+        static_assert(a.value.count() == 2);
+        static_assert((a.value & c.value).count() == 1);
+        static_assert((~a.value).count() == 6);
+    }
+
+    {
+        using FS = ctp::enum_set<Feature>;
+        X<FS{Feature::a, Feature::c}> a;
+        X<FS{Feature::c, Feature::a, Feature::c}> b;
+        X<FS{Feature::b}> c;
+        static_assert(FS::capacity() == 6);
+        static_assert(std::same_as<decltype(a), decltype(b)>);
+        static_assert(!std::same_as<decltype(a), decltype(c)>);
+        static_assert(a.value.contains(Feature::c));
+        static_assert(not a.value.contains(Feature::b));
+        static_assert(a.value.size() == 2);
+        static_assert((a.value | c.value).size() == 3);
+        static_assert((a.value - FS{Feature::a}) == FS{Feature::c});
+        static_assert(FS{Feature::a}.is_subset_of(a.value));
+        static_assert(FS::index_of(Feature(3)) == FS::capacity());
+        static_assert(not FS{Feature(3)}.contains(Feature(3)));
+        static_assert(FS{Feature(3)}.empty());
+
+        using SS = ctp::enum_set<Sparse>;
+        static_assert(SS::capacity() == 2);
+        static_assert(SS{Sparse::hi}.contains(Sparse::hi));
+        static_assert(not SS{Sparse::hi}.contains(Sparse::lo));
+        static_assert(not SS{Sparse::hi}.contains(Sparse(2)));
+        static_assert(SS::index_of(Sparse::lo) != SS::index_of(Sparse::hi));
+        static_assert(SS::index_of(Sparse(2)) == SS::capacity());
+
+        // the range of a narrow enum is computed without promotion to int
+        using NS = ctp::enum_set<Narrow>;
+        static_assert(NS::domain.dense and NS::capacity() == 201);
+        static_assert(NS{Narrow::lo, Narrow::hi}.size() == 2);
+        static_assert(not NS{Narrow(0)}.contains(Narrow(0)));
+
+        using TS = ctp::enum_set<Toggle>;
+        static_assert(TS::capacity() == 2);
+        static_assert(TS{Toggle::on}.contains(Toggle::on) and not TS{Toggle::on}.contains(Toggle::off));
+    }
+
+    {
+        using img = ctp::image<std::tuple<std::string, std::vector<int>, std::optional<std::string>>(
+            "hello", std::vector{1, 2, 3}, "world")>;
+        constexpr auto root = img::root();
+        static_assert(root.get<0>() == "hello"sv);
+        static_assert(root.get<1>().size() == 3);
+        static_assert(root.get<1>()[2] == 3);
+        static_assert(std::ranges::equal(root.get<1>(), std::array{1, 2, 3}));
+        static_assert(*root.get<2>() == "world"sv);
+        static_assert(ctp::open_image<img::type>(img::bytes).has_value());
+        static_assert(not ctp::open_image<std::tuple<int>>(img::bytes).has_value());
+        static_assert(not ctp::open_image<img::type>(img::bytes.first(img::size() - 1)).has_value());
+        // a span whose size runs past the end of the image
+        static_assert(not ctp::open_image<img::type>([]{
+            std::array<char, img::size()> bytes;
+            std::ranges::copy(img::bytes, bytes.begin());
+            constexpr std::size_t size_at = ctp::impl::image_header_size
+                                          + ctp::impl::image_field_offset<img::type, 1>() + 8;
+            std::ranges::copy(std::bit_cast<std::array<char, 8>>(std::uint64_t(1) << 62),
+                              bytes.begin() + size_at);
+            return bytes;
+        }()).has_value());
+
+        using points = ctp::image<std::vector<Point>{{1, 2.5}, {3, 4.5}}>;
+        static_assert(points::root().size() == 2);
+        static_assert(points::root()[1].get<^^Point::x>() == 3);
+        static_assert(points::root()[1].get<1>() == 4.5);
+        // the same layout, but different members
+        static_assert(not ctp::open_image<std::span<Sample const>>(points::bytes).has_value());
+
+        using refs = ctp::image<std::tuple<std::reference_wrapper<Point const>, std::reference_wrapper<Point const>>(
+            origin, origin)>;
+        static_assert(refs::root().get<1>().get<^^Point::y>() == 0.5);
+        // both references share one copy of origin
+        static_assert(refs::size() == ctp::impl::image_header_size + 16 + ctp::impl::image_inline_size<Point>());
+
+        using messages = ctp::image<std::vector<std::variant<int, std::string>>{1, "two"}>;
+        static_assert(messages::root()[0].index() == 0 and messages::root()[0].get<0>() == 1);
+        static_assert(messages::root()[1].get<1>() == "two"sv);
+    }
+
+    {
+        using p = ctp::polynomial<std::vector{1.0, 0.0, -1.0, 0.0}>;
+        static_assert(p::degree_bound == 3);
+        static_assert(p{}(3.0) == -8.0);
+        static_assert(ctp::polynomial<std::vector{0.0}>{}(3.0) == 0.0);
+        static_assert(ctp::polynomial<std::vector{2.0, 3.0}>{}(4) == 14);
+
+        using f = ctp::fir<std::vector{0.5, 0.0, 0.5}>;
+        static_assert([]{
+            std::array in = {1.0, 2.0, 3.0, 4.0};
+            std::array<double, 2> out = {};
+            f::apply<double>(in, out);
+            return out == std::array{2.0, 3.0};
+        }());
+
+        using m = ctp::matvec<std::vector<std::vector<double>>{{1, 0}, {2, -1}}>;
+        static_assert(m::rows == 2 and m::cols == 2);
+        static_assert(m{}(std::array{3.0, 4.0}) == std::array{3.0, 2.0});
+        static_assert(m{}(std::array{3, 4}) == std::array{3, 2});
+        static_assert(not requires { typename ctp::matvec<std::vector<std::vector<double>>{{}}>; });
+    }
+
+    {
+        using primes = ctp::fuse_filter<std::vector{2, 3, 5, 7, 11, 13, 17, 19, 23, 29}>;
+        static_assert(primes::size() == 10);
+        static_assert(primes::contains(2) and primes::contains(29));
+
+        using words = ctp::fuse_filter<std::vector<std::string>{"alpha", "beta", "gamma"}>;
+        static_assert(words::contains("beta"));
+        static_assert(not words::contains("delta"));
+        static_assert(std::same_as<words::key_type, std::string_view>);
+
+        using features = ctp::fuse_filter<std::vector{Feature::a, Feature::c}>;
+        static_assert(features::contains(Feature::c));
+
+        using spread = ctp::fuse_filter<spread_keys(0, 4000)>;
+        static_assert(spread::size() == 4000);
+        static_assert(spread::bits_per_key() > 8 and spread::bits_per_key() < 12);
+        static_assert(std::ranges::all_of(spread_keys(0, 4000), spread::contains));
+        // about 1/256 of 20000 non-members, so well under 1%
+        static_assert(std::ranges::count_if(spread_keys(4000, 20000), spread::contains) < 200);
+    }
 }
\ No newline at end of file